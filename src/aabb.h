@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <limits>
+
+struct AABB {
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+    AABB() = default;
+    AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+    void expand(const AABB& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    glm::vec3 centroid() const {
+        return (min + max) * 0.5f;
+    }
+
+    float surfaceArea() const {
+        glm::vec3 e = max - min;
+        if (e.x < 0.0f || e.y < 0.0f || e.z < 0.0f) return 0.0f;
+        return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+    }
+
+    // Slab test. Returns the entry distance (clamped to 0) or -1 on a miss.
+    // NaNs from 0 * inf are skipped the same way Cube::rayIntersect skips them.
+    float rayEntry(const glm::vec3& rayOrigin, const glm::vec3& invDirection) const {
+        float tMin = 0.0f, tMax = std::numeric_limits<float>::max();
+        for (int i = 0; i < 3; ++i) {
+            float t0 = (min[i] - rayOrigin[i]) * invDirection[i];
+            float t1 = (max[i] - rayOrigin[i]) * invDirection[i];
+            if (invDirection[i] < 0.0f) {
+                std::swap(t0, t1);
+            }
+            tMin = t0 > tMin ? t0 : tMin;
+            tMax = t1 < tMax ? t1 : tMax;
+            if (tMax < tMin) {
+                return -1.0f;
+            }
+        }
+        return tMin;
+    }
+};
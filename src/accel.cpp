@@ -0,0 +1,88 @@
+#include "accel.h"
+
+static glm::vec3 inverseDirection(const glm::vec3& d) {
+    return glm::vec3(1.0f / d.x, 1.0f / d.y, 1.0f / d.z);
+}
+
+void SceneAccel::build(const std::vector<Object*>& objects) {
+    std::vector<BVHPrimitive> staticPrims;
+    dynamicObjects.clear();
+    dynamicIndices.clear();
+
+    for (int i = 0; i < static_cast<int>(objects.size()); ++i) {
+        if (objects[i]->dynamic) {
+            dynamicObjects.push_back(objects[i]);
+            dynamicIndices.push_back(i);
+        } else {
+            staticPrims.push_back({objects[i], i, objects[i]->getBounds()});
+        }
+    }
+
+    staticLevel.build(std::move(staticPrims));
+    dynamicLevel.build(snapshotDynamic());
+    dynamicBuildCost = dynamicLevel.cost();
+}
+
+std::vector<BVHPrimitive> SceneAccel::snapshotDynamic() const {
+    std::vector<BVHPrimitive> prims;
+    prims.reserve(dynamicObjects.size());
+    for (size_t i = 0; i < dynamicObjects.size(); ++i) {
+        prims.push_back({dynamicObjects[i], dynamicIndices[i], dynamicObjects[i]->getBounds()});
+    }
+    return prims;
+}
+
+void SceneAccel::update() {
+    if (dynamicObjects.empty()) return;
+
+    // Swap in a finished rebuild. Objects kept moving while it was built, so refit it first.
+    if (pendingRebuild.valid() &&
+        pendingRebuild.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        dynamicLevel = pendingRebuild.get();
+        dynamicLevel.refit();
+        dynamicBuildCost = dynamicLevel.cost();
+        rebuildCount++;
+        return;
+    }
+
+    dynamicLevel.refit();
+
+    if (!pendingRebuild.valid() && dynamicLevel.cost() > dynamicBuildCost * rebuildThreshold) {
+        // The builder only reads this snapshot, never the live objects
+        pendingRebuild = std::async(std::launch::async, [prims = snapshotDynamic()]() mutable {
+            BVH bvh;
+            bvh.build(std::move(prims));
+            return bvh;
+        });
+    }
+}
+
+bool SceneAccel::intersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, SceneHit& hit) const {
+    glm::vec3 invDirection = inverseDirection(rayDirection);
+
+    // Top level: visit the nearer of the two bottom-level trees first so the
+    // second one can be pruned against the hit distance.
+    float staticEntry = staticLevel.empty() ? -1.0f : staticLevel.bounds().rayEntry(rayOrigin, invDirection);
+    float dynamicEntry = dynamicLevel.empty() ? -1.0f : dynamicLevel.bounds().rayEntry(rayOrigin, invDirection);
+
+    const BVH* first = &staticLevel;
+    const BVH* second = &dynamicLevel;
+    float secondEntry = dynamicEntry;
+    if (dynamicEntry >= 0.0f && (staticEntry < 0.0f || dynamicEntry < staticEntry)) {
+        std::swap(first, second);
+        secondEntry = staticEntry;
+    }
+
+    first->intersect(rayOrigin, rayDirection, invDirection, hit);
+    if (secondEntry >= 0.0f && (hit.object == nullptr || secondEntry <= hit.intersect.dist)) {
+        second->intersect(rayOrigin, rayDirection, invDirection, hit);
+    }
+    return hit.object != nullptr;
+}
+
+bool SceneAccel::intersectShadow(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const Object* ignore, SceneHit& hit) const {
+    glm::vec3 invDirection = inverseDirection(rayDirection);
+    staticLevel.intersectShadow(rayOrigin, rayDirection, invDirection, ignore, hit);
+    dynamicLevel.intersectShadow(rayOrigin, rayDirection, invDirection, ignore, hit);
+    return hit.object != nullptr;
+}
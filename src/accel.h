@@ -0,0 +1,40 @@
+#pragma once
+
+#include <future>
+#include <vector>
+#include <glm/glm.hpp>
+#include "bvh.h"
+#include "object.h"
+
+// Two-level acceleration structure. The top level is a tiny tree over two
+// bottom-level BVHs: one for static objects, built once, and one for animated
+// objects, refitted every frame and rebuilt in the background when its SAH
+// cost drifts past rebuildThreshold times the cost it had when built.
+class SceneAccel {
+public:
+    float rebuildThreshold = 1.5f;
+
+    void build(const std::vector<Object*>& objects);
+
+    // Call once per frame after the animations have moved the objects.
+    // Never blocks on a rebuild in progress.
+    void update();
+
+    bool intersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, SceneHit& hit) const;
+    bool intersectShadow(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const Object* ignore, SceneHit& hit) const;
+
+    int getRebuildCount() const { return rebuildCount; }
+
+private:
+    std::vector<BVHPrimitive> snapshotDynamic() const;
+
+    std::vector<Object*> dynamicObjects;
+    std::vector<int> dynamicIndices;
+
+    BVH staticLevel;
+    BVH dynamicLevel;
+    float dynamicBuildCost = 0.0f;
+
+    std::future<BVH> pendingRebuild;
+    int rebuildCount = 0;
+};
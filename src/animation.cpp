@@ -0,0 +1,43 @@
+#include "animation.h"
+#include <cmath>
+#include <stdexcept>
+
+AnimationTrack::AnimationTrack(Object* target, std::vector<Keyframe> keyframes, bool loop)
+        : target(target), keyframes(std::move(keyframes)), loop(loop) {
+    // apply() interpolates over b.time - a.time, so equal times would divide by zero
+    for (size_t i = 1; i < this->keyframes.size(); ++i) {
+        if (!(this->keyframes[i].time > this->keyframes[i - 1].time)) {
+            throw std::invalid_argument("AnimationTrack: keyframe times must be strictly increasing");
+        }
+    }
+    target->dynamic = true;
+}
+
+void AnimationTrack::apply(float time) const {
+    if (keyframes.empty()) return;
+
+    float duration = keyframes.back().time;
+    if (loop && duration > 0.0f) {
+        time = std::fmod(time, duration);
+    }
+
+    if (time <= keyframes.front().time) {
+        target->transform.translation = keyframes.front().translation;
+        target->transform.scale = keyframes.front().scale;
+        return;
+    }
+
+    for (size_t i = 1; i < keyframes.size(); ++i) {
+        const Keyframe& a = keyframes[i - 1];
+        const Keyframe& b = keyframes[i];
+        if (time <= b.time) {
+            float t = (time - a.time) / (b.time - a.time);
+            target->transform.translation = glm::mix(a.translation, b.translation, t);
+            target->transform.scale = a.scale + (b.scale - a.scale) * t;
+            return;
+        }
+    }
+
+    target->transform.translation = keyframes.back().translation;
+    target->transform.scale = keyframes.back().scale;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "object.h"
+
+struct Keyframe {
+    float time;
+    glm::vec3 translation;
+    float scale = 1.0f;
+};
+
+// Linear keyframe track driving one object's transform. Attaching a track
+// marks the object as dynamic so the acceleration structure refits it.
+// Keyframe times must be strictly increasing (std::invalid_argument otherwise).
+class AnimationTrack {
+public:
+    AnimationTrack(Object* target, std::vector<Keyframe> keyframes, bool loop = true);
+
+    void apply(float time) const;
+
+private:
+    Object* target;
+    std::vector<Keyframe> keyframes;
+    bool loop;
+};
@@ -0,0 +1,57 @@
+#include "assets.h"
+#include <iostream>
+#include <SDL_image.h>
+
+AssetLoader::AssetLoader(bool compressTextures, unsigned threadCount)
+        : compressTextures(compressTextures), pool(threadCount) {
+    // IMG_Init is not thread safe, so it has to run before the first job is
+    // submitted. The skybox is a JPEG even though it is named .png.
+    if ((IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) & IMG_INIT_PNG) == 0) {
+        std::cerr << "Unable to initialize SDL_image: " << IMG_GetError() << std::endl;
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    pool.wait();
+    IMG_Quit();
+}
+
+Texture* AssetLoader::load(const std::string& file, Color placeholder) {
+    textures.push_back(std::make_unique<Texture>(placeholder));
+    Texture* texture = textures.back().get();
+    load(*texture, file);
+    return texture;
+}
+
+void AssetLoader::load(Texture& texture, const std::string& file) {
+    pendingCount++;
+    pool.submit([this, &texture, file]() {
+        SDL_Surface* raw = IMG_Load(file.c_str());
+        if (raw == nullptr) {
+            std::cerr << "Unable to load image " << file << ": " << IMG_GetError() << std::endl;
+            pendingCount--;
+            return;
+        }
+
+        // Convert once here so the sampler can read texels without SDL_GetRGB
+        SDL_Surface* converted = SDL_ConvertSurfaceFormat(raw, SDL_PIXELFORMAT_ARGB8888, 0);
+        SDL_FreeSurface(raw);
+        if (converted == nullptr) {
+            std::cerr << "Unable to convert image " << file << ": " << SDL_GetError() << std::endl;
+            pendingCount--;
+            return;
+        }
+
+        if (compressTextures) {
+            auto image = std::make_unique<BlockCompressedImage>(converted);
+            // One write per line so messages from different workers do not interleave
+            std::cout << "Compressed " + file + ": " + std::to_string(converted->pitch * converted->h) +
+                         " -> " + std::to_string(image->getSizeInBytes()) + " bytes\n" << std::flush;
+            texture.setCompressed(std::move(image));
+            SDL_FreeSurface(converted);
+        } else {
+            texture.setSurface(converted);
+        }
+        pendingCount--;
+    });
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "texture.h"
+#include "threadpool.h"
+
+// Decodes and converts images on a thread pool. load() returns right away
+// with a texture that shows its placeholder color until the decoded
+// surface is swapped in. Construct it on the thread that owns SDL: the
+// constructor initializes SDL_image before any job can call IMG_Load.
+class AssetLoader {
+public:
+    // compressTextures stores every texture block compressed (see BlockCompressedImage).
+    explicit AssetLoader(bool compressTextures = false,
+                         unsigned threadCount = std::thread::hardware_concurrency());
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    Texture* load(const std::string& file, Color placeholder);
+    void load(Texture& texture, const std::string& file);
+
+    // Images still being decoded
+    int pending() const { return pendingCount.load(); }
+    void wait() { pool.wait(); }
+
+private:
+    const bool compressTextures;
+    std::vector<std::unique_ptr<Texture>> textures;
+    std::atomic<int> pendingCount{0};
+    ThreadPool pool;  // declared last so workers are joined before the textures are freed
+};
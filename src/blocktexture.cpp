@@ -0,0 +1,145 @@
+#include "blocktexture.h"
+#include <algorithm>
+#include <atomic>
+
+static const int CACHE_SLOTS = 256;  // 256 blocks * 64 bytes = 16 KB per thread
+
+struct DecodedBlockCache {
+    uint64_t tags[CACHE_SLOTS];
+    Uint32 texels[CACHE_SLOTS][16];
+
+    DecodedBlockCache() {
+        for (auto& tag : tags) tag = ~0ull;
+    }
+};
+
+static thread_local DecodedBlockCache blockCache;
+static std::atomic<uint32_t> nextImageId{0};
+
+static Uint16 packRGB565(int r, int g, int b) {
+    return static_cast<Uint16>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+static Uint32 unpackRGB565(Uint16 c) {
+    int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+    r = (r << 3) | (r >> 2);
+    g = (g << 2) | (g >> 4);
+    b = (b << 3) | (b >> 2);
+    return 0xFF000000u | (r << 16) | (g << 8) | b;
+}
+
+static int channel(Uint32 argb, int c) {
+    return (argb >> (16 - 8 * c)) & 0xFF;
+}
+
+static Uint32 blend(Uint32 a, Uint32 b, int wa, int wb) {
+    Uint32 out = 0xFF000000u;
+    for (int c = 0; c < 3; ++c) {
+        int v = (channel(a, c) * wa + channel(b, c) * wb) / (wa + wb);
+        out |= static_cast<Uint32>(v) << (16 - 8 * c);
+    }
+    return out;
+}
+
+static void buildPalette(Uint16 c0, Uint16 c1, Uint32 palette[4]) {
+    palette[0] = unpackRGB565(c0);
+    palette[1] = unpackRGB565(c1);
+    palette[2] = blend(palette[0], palette[1], 2, 1);
+    palette[3] = blend(palette[0], palette[1], 1, 2);
+}
+
+static uint64_t encodeBlock(const Uint32 texels[16]) {
+    // Endpoints: bounding box of the block, with the minor channels flipped
+    // when they run against the channel of largest variance.
+    float mean[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 3; ++c) mean[c] += channel(texels[i], c) / 16.0f;
+
+    float cov[3][3] = {};
+    int lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            int v = channel(texels[i], c);
+            lo[c] = std::min(lo[c], v);
+            hi[c] = std::max(hi[c], v);
+            for (int k = 0; k < 3; ++k) cov[c][k] += (v - mean[c]) * (channel(texels[i], k) - mean[k]);
+        }
+    }
+    int major = 0;
+    for (int c = 1; c < 3; ++c) if (cov[c][c] > cov[major][major]) major = c;
+    for (int c = 0; c < 3; ++c) {
+        if (c != major && cov[major][c] < 0) std::swap(lo[c], hi[c]);
+    }
+
+    Uint16 c0 = packRGB565(hi[0], hi[1], hi[2]);
+    Uint16 c1 = packRGB565(lo[0], lo[1], lo[2]);
+    if (c0 < c1) std::swap(c0, c1);
+
+    Uint32 palette[4];
+    buildPalette(c0, c1, palette);
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        for (int i = 0; i < 16; ++i) {
+            int best = 0, bestDist = 1 << 30;
+            for (int p = 0; p < 4; ++p) {
+                int dist = 0;
+                for (int c = 0; c < 3; ++c) {
+                    int d = channel(texels[i], c) - channel(palette[p], c);
+                    dist += d * d;
+                }
+                if (dist < bestDist) {
+                    bestDist = dist;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+        }
+    }
+
+    return static_cast<uint64_t>(c0) | (static_cast<uint64_t>(c1) << 16) | (static_cast<uint64_t>(indices) << 32);
+}
+
+BlockCompressedImage::BlockCompressedImage(const SDL_Surface* surface)
+        : width(surface->w), height(surface->h), blocksWide((surface->w + 3) / 4), id(nextImageId++) {
+    int blocksHigh = (height + 3) / 4;
+    blocks.resize(static_cast<size_t>(blocksWide) * blocksHigh);
+
+    const Uint8* pixels = static_cast<const Uint8*>(surface->pixels);
+    for (int by = 0; by < blocksHigh; ++by) {
+        for (int bx = 0; bx < blocksWide; ++bx) {
+            Uint32 texels[16];
+            for (int i = 0; i < 16; ++i) {
+                // Blocks on the right/bottom edge repeat the last row/column
+                int x = std::min(bx * 4 + i % 4, width - 1);
+                int y = std::min(by * 4 + i / 4, height - 1);
+                texels[i] = reinterpret_cast<const Uint32*>(pixels + y * surface->pitch)[x];
+            }
+            blocks[by * blocksWide + bx] = encodeBlock(texels);
+        }
+    }
+}
+
+const Uint32* BlockCompressedImage::decodeBlock(int blockIndex) const {
+    uint64_t tag = (static_cast<uint64_t>(id) << 32) | static_cast<uint32_t>(blockIndex);
+    int slot = static_cast<int>((blockIndex ^ (id * 0x9E3779B1u)) & (CACHE_SLOTS - 1));
+
+    Uint32* decoded = blockCache.texels[slot];
+    if (blockCache.tags[slot] == tag) return decoded;
+
+    uint64_t block = blocks[blockIndex];
+    Uint32 palette[4];
+    buildPalette(static_cast<Uint16>(block), static_cast<Uint16>(block >> 16), palette);
+    uint32_t indices = static_cast<uint32_t>(block >> 32);
+    for (int i = 0; i < 16; ++i) {
+        decoded[i] = palette[(indices >> (2 * i)) & 3];
+    }
+    blockCache.tags[slot] = tag;
+    return decoded;
+}
+
+Color BlockCompressedImage::getTexel(int x, int y) const {
+    const Uint32* decoded = decodeBlock((y >> 2) * blocksWide + (x >> 2));
+    Uint32 pixel = decoded[(y & 3) * 4 + (x & 3)];
+    return Color(int((pixel >> 16) & 0xFF), int((pixel >> 8) & 0xFF), int(pixel & 0xFF));
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <SDL2/SDL.h>
+#include "color.h"
+
+// BC1-style block compressed image: every 4x4 block is 8 bytes, two RGB565
+// endpoints plus sixteen 2-bit palette indices (4 bits per texel instead of
+// 32). Alpha is dropped, the ray tracer only samples RGB.
+//
+// Lookups decode the whole block into a small per-thread direct-mapped cache,
+// so neighbouring rays reuse it instead of decoding again.
+class BlockCompressedImage {
+public:
+    // surface must be SDL_PIXELFORMAT_ARGB8888.
+    explicit BlockCompressedImage(const SDL_Surface* surface);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    size_t getSizeInBytes() const { return blocks.size() * sizeof(uint64_t); }
+
+    Color getTexel(int x, int y) const;
+
+private:
+    const Uint32* decodeBlock(int blockIndex) const;
+
+    int width;
+    int height;
+    int blocksWide;
+    uint32_t id;  // unique per image, part of the cache tag
+    std::vector<uint64_t> blocks;
+};
@@ -0,0 +1,160 @@
+#include "bvh.h"
+#include <algorithm>
+#include <cassert>
+
+static const int MAX_LEAF_SIZE = 2;
+static const int MAX_STACK_DEPTH = 64;
+
+void BVH::build(std::vector<BVHPrimitive> prims) {
+    primitives = std::move(prims);
+    nodes.clear();
+    if (primitives.empty()) return;
+    nodes.reserve(2 * primitives.size());
+    depth = 0;
+    buildRecursive(0, static_cast<int>(primitives.size()), 0);
+    // Traversal keeps at most one pending sibling per level plus the two children
+    assert(depth + 2 <= MAX_STACK_DEPTH);
+}
+
+int BVH::buildRecursive(int first, int count, int level) {
+    int nodeIndex = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+
+    AABB bounds, centroidBounds;
+    for (int i = first; i < first + count; ++i) {
+        bounds.expand(primitives[i].bounds);
+        glm::vec3 c = primitives[i].bounds.centroid();
+        centroidBounds.expand(AABB(c, c));
+    }
+    nodes[nodeIndex].bounds = bounds;
+    depth = std::max(depth, level);
+
+    if (count <= MAX_LEAF_SIZE) {
+        nodes[nodeIndex].first = first;
+        nodes[nodeIndex].count = count;
+        return nodeIndex;
+    }
+
+    // Median split on the longest centroid axis
+    glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    int mid = first + count / 2;
+    std::nth_element(primitives.begin() + first, primitives.begin() + mid, primitives.begin() + first + count,
+                     [axis](const BVHPrimitive& a, const BVHPrimitive& b) {
+                         return a.bounds.centroid()[axis] < b.bounds.centroid()[axis];
+                     });
+
+    buildRecursive(first, mid - first, level + 1);
+    int right = buildRecursive(mid, first + count - mid, level + 1);
+    nodes[nodeIndex].right = right;
+    return nodeIndex;
+}
+
+void BVH::refit() {
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; --i) {
+        Node& node = nodes[i];
+        AABB bounds;
+        if (node.count > 0) {
+            for (int p = node.first; p < node.first + node.count; ++p) {
+                primitives[p].bounds = primitives[p].object->getBounds();
+                bounds.expand(primitives[p].bounds);
+            }
+        } else {
+            bounds.expand(nodes[i + 1].bounds);
+            bounds.expand(nodes[node.right].bounds);
+        }
+        node.bounds = bounds;
+    }
+}
+
+float BVH::cost() const {
+    if (nodes.empty()) return 0.0f;
+    float rootArea = nodes[0].bounds.surfaceArea();
+    if (rootArea <= 0.0f) return 0.0f;
+
+    float total = 0.0f;
+    for (const Node& node : nodes) {
+        float area = node.bounds.surfaceArea();
+        total += node.count > 0 ? area * node.count : area;
+    }
+    return total / rootArea;
+}
+
+void BVH::intersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3& invDirection, SceneHit& hit) const {
+    if (nodes.empty()) return;
+
+    int stack[MAX_STACK_DEPTH];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        float entry = node.bounds.rayEntry(rayOrigin, invDirection);
+        // Equal distances can still win on index, so only prune strictly farther nodes
+        if (entry < 0.0f || (hit.object != nullptr && entry > hit.intersect.dist)) continue;
+
+        if (node.count > 0) {
+            for (int p = node.first; p < node.first + node.count; ++p) {
+                const BVHPrimitive& prim = primitives[p];
+                Intersect i = prim.object->rayIntersect(rayOrigin, rayDirection);
+                if (!i.isIntersecting) continue;
+                if (hit.object == nullptr || i.dist < hit.intersect.dist ||
+                    (i.dist == hit.intersect.dist && prim.index < hit.index)) {
+                    hit.intersect = i;
+                    hit.object = prim.object;
+                    hit.index = prim.index;
+                }
+            }
+            continue;
+        }
+
+        int left = static_cast<int>(&node - nodes.data()) + 1;
+        int right = node.right;
+        float leftEntry = nodes[left].bounds.rayEntry(rayOrigin, invDirection);
+        float rightEntry = nodes[right].bounds.rayEntry(rayOrigin, invDirection);
+        assert(stackSize + 2 <= MAX_STACK_DEPTH);
+        // Push the farther child first so the nearer one is visited first
+        if (leftEntry >= 0.0f && rightEntry >= 0.0f && leftEntry < rightEntry) {
+            stack[stackSize++] = right;
+            stack[stackSize++] = left;
+        } else {
+            if (leftEntry >= 0.0f) stack[stackSize++] = left;
+            if (rightEntry >= 0.0f) stack[stackSize++] = right;
+        }
+    }
+}
+
+void BVH::intersectShadow(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3& invDirection, const Object* ignore, SceneHit& hit) const {
+    if (nodes.empty()) return;
+
+    int stack[MAX_STACK_DEPTH];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = nodes[stack[--stackSize]];
+        if (node.bounds.rayEntry(rayOrigin, invDirection) < 0.0f) continue;
+
+        if (node.count > 0) {
+            for (int p = node.first; p < node.first + node.count; ++p) {
+                const BVHPrimitive& prim = primitives[p];
+                if (prim.object == ignore) continue;
+                if (hit.object != nullptr && prim.index > hit.index) continue;
+                Intersect i = prim.object->rayIntersect(rayOrigin, rayDirection);
+                if (i.isIntersecting && i.dist > 0) {
+                    hit.intersect = i;
+                    hit.object = prim.object;
+                    hit.index = prim.index;
+                }
+            }
+            continue;
+        }
+
+        assert(stackSize + 2 <= MAX_STACK_DEPTH);
+        stack[stackSize++] = node.right;
+        stack[stackSize++] = static_cast<int>(&node - nodes.data()) + 1;
+    }
+}
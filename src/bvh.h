@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "aabb.h"
+#include "object.h"
+#include "intersect.h"
+
+struct BVHPrimitive {
+    Object* object;
+    int index;      // posicion en la lista de objetos de la escena, para desempates
+    AABB bounds;    // bounds at build time; refit() reads them again from the object
+};
+
+struct SceneHit {
+    Intersect intersect;
+    Object* object = nullptr;
+    int index = -1;
+};
+
+// Bounding volume hierarchy over scene objects. Nodes are stored in
+// depth-first order (children after their parent) so refit() is a single
+// reverse sweep.
+class BVH {
+public:
+    void build(std::vector<BVHPrimitive> prims);
+    void refit();
+
+    // SAH cost normalized by the root area; grows as refitted nodes overlap.
+    float cost() const;
+    bool empty() const { return nodes.empty(); }
+    AABB bounds() const { return nodes.empty() ? AABB() : nodes[0].bounds; }
+
+    // Nearest hit; ties go to the lowest scene index like the plain object loop.
+    void intersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3& invDirection, SceneHit& hit) const;
+
+    // Lowest-index hit in front of the origin, ignoring `ignore` (castShadow semantics).
+    void intersectShadow(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3& invDirection, const Object* ignore, SceneHit& hit) const;
+
+private:
+    struct Node {
+        AABB bounds;
+        int right = -1;   // left child is always node + 1
+        int first = 0;
+        int count = 0;    // > 0 for leaves
+    };
+
+    int buildRecursive(int first, int count, int level);
+
+    int depth = 0;    // deepest level reached by the last build
+    std::vector<Node> nodes;
+    std::vector<BVHPrimitive> primitives;
+};
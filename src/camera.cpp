@@ -17,3 +17,23 @@ void Camera::move(float deltaZ) {
   glm::vec3 dir = glm::normalize(target - position);
   position += dir * deltaZ;
 }
+
+RayGenerator::RayGenerator(const Camera& camera, float fov, int width, int height)
+  : origin(camera.position), width(width), height(height)
+{
+  forward = glm::normalize(camera.target - camera.position);
+  right = glm::normalize(glm::cross(forward, camera.up));
+  up = glm::normalize(glm::cross(right, forward));
+  aspectRatio = static_cast<float>(width) / static_cast<float>(height);
+  tanHalfFov = tan(fov / 2.0f);
+}
+
+glm::vec3 RayGenerator::direction(int x, int y) const {
+  float screenX = (2.0f * (x + 0.5f)) / width - 1.0f;
+  float screenY = -(2.0f * (y + 0.5f)) / height + 1.0f;
+  screenX *= aspectRatio;
+  screenX *= tanHalfFov;
+  screenY *= tanHalfFov;
+
+  return glm::normalize(forward + right * screenX + up * screenY);
+}
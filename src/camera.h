@@ -16,3 +16,19 @@ public:
   void move(float deltaZ);
 };
 
+// Primary ray directions for a width x height image seen from a camera.
+// Computes the same vectors render() used to rebuild for every pixel.
+struct RayGenerator {
+  RayGenerator(const Camera& camera, float fov, int width, int height);
+
+  glm::vec3 direction(int x, int y) const;
+
+  glm::vec3 origin;
+  glm::vec3 forward;
+  glm::vec3 right;
+  glm::vec3 up;
+  float aspectRatio;
+  float tanHalfFov;
+  int width;
+  int height;
+};
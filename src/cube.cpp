@@ -4,6 +4,8 @@ Cube::Cube(const glm::vec3& center, float edgeLength, const Material& mat)
         : center(center), edgeLength(edgeLength), Object(mat) {}
 
 Intersect Cube::rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const {
+    glm::vec3 center = this->center + transform.translation;
+    float edgeLength = this->edgeLength * transform.scale;
     float tMin = 0.0f, tMax = std::numeric_limits<float>::max();
     glm::vec3 bounds[2];
     bounds[0] = center - glm::vec3(edgeLength / 2.0f);
@@ -56,3 +58,8 @@ Intersect Cube::rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDir
     glm::vec3 point = rayOrigin + tMin * rayDirection;
     return Intersect{true, tMin, point, normal, tx, ty};
 }
+
+AABB Cube::getBounds() const {
+    glm::vec3 halfEdge(edgeLength * transform.scale / 2.0f);
+    return AABB(center + transform.translation - halfEdge, center + transform.translation + halfEdge);
+}
@@ -10,6 +10,7 @@ public:
     Cube(const glm::vec3& center, float edgeLength, const Material& mat);
 
     Intersect rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const override;
+    AABB getBounds() const override;
 
 private:
     glm::vec3 center;
@@ -0,0 +1,139 @@
+#include "exporter.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include "imagefile.h"
+
+std::vector<CameraKeyframe> parseCameraPath(const std::string& spec) {
+    std::vector<CameraKeyframe> path;
+    std::stringstream segments(spec);
+    std::string segment;
+    while (std::getline(segments, segment, ',')) {
+        CameraKeyframe key = {0, 0.0f, 0.0f};
+        // All three fields and nothing after them, so a typo fails instead of rendering a static clip
+        int consumed = 0;
+        if (std::sscanf(segment.c_str(), "%d:%f:%f%n", &key.frames, &key.rotate, &key.move, &consumed) != 3 ||
+            consumed != static_cast<int>(segment.size()) || key.frames <= 0) {
+            std::cerr << "Invalid camera path segment: " << segment << std::endl;
+            return {};
+        }
+        path.push_back(key);
+    }
+    if (path.empty()) {
+        std::cerr << "Empty camera path" << std::endl;
+    }
+    return path;
+}
+
+int cameraPathLength(const std::vector<CameraKeyframe>& path) {
+    int frames = 0;
+    for (const CameraKeyframe& key : path) frames += key.frames;
+    return frames;
+}
+
+void stepCameraPath(Camera& camera, const std::vector<CameraKeyframe>& path, int frame) {
+    if (frame == 0) return;  // frame 0 is the starting pose
+    for (const CameraKeyframe& key : path) {
+        if (frame <= key.frames) {
+            camera.rotate(key.rotate / key.frames, 0.0f);
+            if (key.move != 0.0f) camera.move(key.move / key.frames);
+            return;
+        }
+        frame -= key.frames;
+    }
+}
+
+FrameWriter::FrameWriter(Format format, const std::string& path, int width, int height, size_t maxQueuedFrames)
+        : format(format), path(path), width(width), height(height), maxQueuedFrames(std::max<size_t>(1, maxQueuedFrames)) {
+    if (format == Format::ImageSequence) {
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        if (error || !std::filesystem::is_directory(path, error)) {
+            std::cerr << "Unable to create output directory " << path << ": " << error.message() << std::endl;
+            opened = false;
+        }
+    } else {
+        rawFile = std::fopen(path.c_str(), "wb");
+        if (rawFile == nullptr) {
+            std::cerr << "Unable to open video output: " << path << std::endl;
+            opened = false;
+        }
+    }
+    failed = !opened;
+    writer = std::thread(&FrameWriter::writerLoop, this);
+}
+
+FrameWriter::~FrameWriter() {
+    finish();
+}
+
+std::vector<Color> FrameWriter::acquireBuffer() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (freeBuffers.empty()) {
+        return std::vector<Color>(static_cast<size_t>(width) * height);
+    }
+    std::vector<Color> buffer = std::move(freeBuffers.back());
+    freeBuffers.pop_back();
+    return buffer;
+}
+
+void FrameWriter::submit(std::vector<Color> frame) {
+    std::unique_lock<std::mutex> lock(mutex);
+    frameWritten.wait(lock, [this] { return queue.size() < maxQueuedFrames; });
+    queue.push_back(std::move(frame));
+    frameQueued.notify_one();
+}
+
+bool FrameWriter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    frameQueued.notify_one();
+    if (writer.joinable()) writer.join();
+
+    if (rawFile != nullptr) {
+        if (std::fclose(rawFile) != 0) failed = true;
+        rawFile = nullptr;
+    }
+    return !failed;
+}
+
+void FrameWriter::writerLoop() {
+    int index = 0;
+    while (true) {
+        std::vector<Color> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            frameQueued.wait(lock, [this] { return finished || !queue.empty(); });
+            if (queue.empty()) return;
+            frame = std::move(queue.front());
+            queue.pop_front();
+        }
+        frameWritten.notify_one();
+
+        bool ok = writeFrame(index++, frame);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!ok) failed = true;
+        freeBuffers.push_back(std::move(frame));
+    }
+}
+
+bool FrameWriter::writeFrame(int index, const std::vector<Color>& frame) {
+    if (format == Format::ImageSequence) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/frame_%05d.ppm", index);
+        return writePPM(path + name, width, height, frame);
+    }
+
+    if (rawFile == nullptr) return false;
+    encoded.resize(frame.size() * 3);
+    for (size_t i = 0; i < frame.size(); ++i) {
+        encoded[i * 3 + 0] = frame[i].r;
+        encoded[i * 3 + 1] = frame[i].g;
+        encoded[i * 3 + 2] = frame[i].b;
+    }
+    return std::fwrite(encoded.data(), 1, encoded.size(), rawFile) == encoded.size();
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "camera.h"
+#include "color.h"
+
+// One segment of a camera path: over `frames` frames the camera turns by
+// `rotate` (same units as Camera::rotate, which applies its rotation twice,
+// so one unit is 2 * rotationSpeed degrees) and dollies by `move`.
+struct CameraKeyframe {
+    int frames;
+    float rotate;
+    float move;
+};
+
+// Parses "frames:rotate:move,frames:rotate:move,...". Every segment needs all
+// three fields. Returns an empty path on errors.
+std::vector<CameraKeyframe> parseCameraPath(const std::string& spec);
+
+// Moves the camera to the pose of frame `frame` along the path, given the pose of frame - 1.
+void stepCameraPath(Camera& camera, const std::vector<CameraKeyframe>& path, int frame);
+
+int cameraPathLength(const std::vector<CameraKeyframe>& path);
+
+// Writes rendered frames on its own I/O thread so that encoding and disk
+// writes of frame N overlap with tracing frame N + 1. At most maxQueuedFrames
+// frames wait in memory; submit() blocks beyond that.
+class FrameWriter {
+public:
+    enum class Format {
+        ImageSequence,  // <path>/frame_00000.ppm, ...
+        RawVideo        // RGB24 frames back to back in one file, e.g. for ffmpeg -f rawvideo
+    };
+
+    FrameWriter(Format format, const std::string& path, int width, int height, size_t maxQueuedFrames = 3);
+    ~FrameWriter();
+
+    // False if the output directory or file could not be created. Check it
+    // before rendering; nothing submitted afterwards would be written.
+    bool ok() const { return opened; }
+
+    // A width * height buffer, recycled from already written frames when possible.
+    std::vector<Color> acquireBuffer();
+    void submit(std::vector<Color> frame);
+
+    // Waits for the queue to drain. Returns false if any frame failed to write.
+    bool finish();
+
+private:
+    void writerLoop();
+    bool writeFrame(int index, const std::vector<Color>& frame);
+
+    Format format;
+    std::string path;
+    int width;
+    int height;
+    size_t maxQueuedFrames;
+
+    std::mutex mutex;
+    std::condition_variable frameQueued;
+    std::condition_variable frameWritten;
+    std::deque<std::vector<Color>> queue;
+    std::vector<std::vector<Color>> freeBuffers;
+    bool finished = false;
+    bool failed = false;
+    bool opened = true;  // set by the constructor only, so ok() needs no lock
+
+    FILE* rawFile = nullptr;
+    std::vector<Uint8> encoded;
+    std::thread writer;
+};
@@ -0,0 +1,446 @@
+#include "farm.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+enum FarmMessageType : uint32_t {
+    FARM_JOB = 1,     // coordinator -> worker, payload FarmJob
+    FARM_TILE,        // coordinator -> worker, payload FarmTile
+    FARM_QUIT,        // coordinator -> worker
+    FARM_READY,       // worker -> coordinator, scene loaded and job applied
+    FARM_RESULT       // worker -> coordinator, payload FarmTile + RGB bytes
+};
+
+struct FarmMessageHeader {
+    uint32_t type;
+    uint32_t size;
+};
+
+using FarmClock = std::chrono::steady_clock;
+
+// A worker that died must not kill the coordinator with SIGPIPE. Linux has a
+// per-call flag; macOS has SO_NOSIGPIPE on the socket instead (see spawnWorker).
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+// Blocking read, used by the worker. The coordinator never blocks on a
+// worker; it buffers what arrives in receiveAvailable() instead.
+static bool readAll(int fd, void* data, size_t size) {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = read(fd, bytes, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        bytes += n;
+        size -= n;
+    }
+    return true;
+}
+
+static bool writeAll(int fd, const void* data, size_t size) {
+    auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = send(fd, bytes, size, SEND_FLAGS);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Non-blocking coordinator socket: wait a bounded time for room
+            pollfd out = {fd, POLLOUT, 0};
+            if (poll(&out, 1, 1000) > 0) continue;
+            return false;
+        }
+        if (n <= 0) return false;
+        bytes += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Appends everything a non-blocking socket has ready to inbox. Returns false
+// once the peer has closed the connection or the socket failed.
+static bool receiveAvailable(int fd, std::vector<Uint8>& inbox) {
+    Uint8 chunk[16384];
+    while (true) {
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n > 0) {
+            inbox.insert(inbox.end(), chunk, chunk + n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+    }
+}
+
+static bool sendMessage(int fd, FarmMessageType type, const void* payload = nullptr, size_t size = 0) {
+    FarmMessageHeader header = {type, static_cast<uint32_t>(size)};
+    return writeAll(fd, &header, sizeof(header)) && (size == 0 || writeAll(fd, payload, size));
+}
+
+// ---------------------------------------------------------------------------
+// Worker
+
+int runFarmWorker(int fd, int delayMs, const FarmJobSetup& setup, const FarmTileRenderer& render) {
+    std::vector<Color> pixels;
+    std::vector<Uint8> message;
+
+    while (true) {
+        FarmMessageHeader header;
+        if (!readAll(fd, &header, sizeof(header))) return 1;
+
+        if (header.type == FARM_QUIT) return 0;
+
+        if (header.type == FARM_JOB && header.size == sizeof(FarmJob)) {
+            FarmJob job;
+            if (!readAll(fd, &job, sizeof(job))) return 1;
+            setup(job);
+            if (!sendMessage(fd, FARM_READY)) return 1;
+        } else if (header.type == FARM_TILE && header.size == sizeof(FarmTile)) {
+            FarmTile tile;
+            if (!readAll(fd, &tile, sizeof(tile))) return 1;
+            if (delayMs > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            }
+
+            pixels.assign(tile.pixelCount(), Color());
+            render(tile, pixels);
+
+            message.resize(sizeof(FarmTile) + pixels.size() * 3);
+            std::memcpy(message.data(), &tile, sizeof(FarmTile));
+            Uint8* rgb = message.data() + sizeof(FarmTile);
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                rgb[i * 3 + 0] = pixels[i].r;
+                rgb[i * 3 + 1] = pixels[i].g;
+                rgb[i * 3 + 2] = pixels[i].b;
+            }
+            if (!sendMessage(fd, FARM_RESULT, message.data(), message.size())) return 1;
+        } else {
+            std::cerr << "farm worker: unexpected message " << header.type << std::endl;
+            return 1;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Coordinator
+
+namespace {
+
+struct Assignment {
+    int tile;
+    FarmClock::time_point start;
+};
+
+struct WorkerProcess {
+    pid_t pid = -1;
+    int fd = -1;
+    bool alive = false;
+    bool ready = false;
+    int tilesSent = 0;
+    FarmClock::time_point lastProgress;
+    std::vector<Assignment> inFlight;
+    std::vector<Uint8> inbox;  // received bytes not yet parsed into messages
+};
+
+struct TileState {
+    FarmTile tile;
+    bool done = false;
+    int issued = 0;  // assignments currently out, including duplicates
+};
+
+bool spawnWorker(WorkerProcess& worker, int index, const FarmOptions& options) {
+    // Build argv before forking; the child should only exec
+    std::vector<std::string> args = {options.workerExecutable, "--farm-worker", "",
+                                     "--farm-worker-delay", std::to_string(index == 1 ? options.slowWorkerDelayMs : 0)};
+    args.insert(args.end(), options.workerArgs.begin(), options.workerArgs.end());
+    char fdArg[16] = "";
+    std::vector<char*> argv;
+    for (std::string& arg : args) argv.push_back(arg.data());
+    argv[2] = fdArg;  // filled in by the child once it knows its descriptor
+    argv.push_back(nullptr);
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) {
+        std::cerr << "farm: socketpair failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    // SOCK_CLOEXEC is Linux only. The coordinator is single threaded, so
+    // nothing can fork between socketpair() and these calls.
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    setsockopt(fds[1], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "farm: fork failed: " << std::strerror(errno) << std::endl;
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (pid == 0) {
+        // dup() drops CLOEXEC, so only this end survives the exec
+        int childFd = dup(fds[1]);
+        std::snprintf(fdArg, sizeof(fdArg), "%d", childFd);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    close(fds[1]);
+    // A worker stalled halfway through a message must not block the coordinator
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    worker.pid = pid;
+    worker.fd = fds[0];
+    worker.alive = true;
+    worker.lastProgress = FarmClock::now();
+    return true;
+}
+
+}  // namespace
+
+bool runFarmCoordinator(const FarmOptions& options, const FarmJob& job, std::vector<Color>& image) {
+    if (options.tileSize <= 0 || job.width <= 0 || job.height <= 0) {
+        std::cerr << "farm: tile size and image size must be positive" << std::endl;
+        return false;
+    }
+    if (options.workerExecutable.empty()) {
+        std::cerr << "farm: no worker executable given" << std::endl;
+        return false;
+    }
+    image.assign(static_cast<size_t>(job.width) * job.height, Color());
+
+    std::vector<TileState> tiles;
+    for (int y = 0; y < job.height; y += options.tileSize) {
+        for (int x = 0; x < job.width; x += options.tileSize) {
+            TileState state;
+            state.tile = {static_cast<int>(tiles.size()), x, y,
+                          std::min(x + options.tileSize, job.width), std::min(y + options.tileSize, job.height)};
+            tiles.push_back(state);
+        }
+    }
+
+    std::deque<int> pending;
+    for (const TileState& state : tiles) pending.push_back(state.tile.id);
+
+    std::vector<WorkerProcess> workers(std::max(1, options.workerCount));
+    for (int i = 0; i < static_cast<int>(workers.size()); ++i) {
+        if (spawnWorker(workers[i], i, options)) {
+            sendMessage(workers[i].fd, FARM_JOB, &job, sizeof(job));
+        }
+    }
+
+    size_t tilesDone = 0;
+    double averageTileSeconds = 0.0;
+    const size_t maxMessageSize = sizeof(FarmTile) + static_cast<size_t>(options.tileSize) * options.tileSize * 3;
+
+    auto retire = [&](WorkerProcess& worker, const char* reason) {
+        if (!worker.alive) return;
+        kill(worker.pid, SIGKILL);
+        close(worker.fd);
+        worker.alive = false;
+        int requeued = 0;
+        for (const Assignment& a : worker.inFlight) {
+            // A duplicate still running on another worker covers the tile
+            if (--tiles[a.tile].issued == 0 && !tiles[a.tile].done) {
+                pending.push_front(a.tile);
+                requeued++;
+            }
+        }
+        // farm_fault_tolerance.cmake checks this line for a non-zero count
+        std::cerr << "farm: worker " << worker.pid << " " << reason << ", re-queued "
+                  << requeued << " of " << worker.inFlight.size() << " tile(s)" << std::endl;
+        worker.inFlight.clear();
+    };
+
+    auto handleMessage = [&](WorkerProcess& worker, const FarmMessageHeader& header, const Uint8* payload) {
+        if (header.type == FARM_READY) {
+            worker.ready = true;
+            worker.lastProgress = FarmClock::now();
+            return;
+        }
+
+        if (header.type != FARM_RESULT || header.size < sizeof(FarmTile)) {
+            retire(worker, "sent a bad message");
+            return;
+        }
+
+        FarmTile tile;
+        std::memcpy(&tile, payload, sizeof(FarmTile));
+        if (tile.id < 0 || tile.id >= static_cast<int>(tiles.size()) ||
+            header.size != sizeof(FarmTile) + static_cast<size_t>(tiles[tile.id].tile.pixelCount()) * 3) {
+            retire(worker, "sent a bad tile");
+            return;
+        }
+        tile = tiles[tile.id].tile;
+
+        auto it = std::find_if(worker.inFlight.begin(), worker.inFlight.end(),
+                               [&](const Assignment& a) { return a.tile == tile.id; });
+        if (it != worker.inFlight.end()) {
+            double seconds = std::chrono::duration<double>(FarmClock::now() - it->start).count();
+            averageTileSeconds = tilesDone == 0 ? seconds : averageTileSeconds * 0.9 + seconds * 0.1;
+            worker.inFlight.erase(it);
+            tiles[tile.id].issued--;
+        }
+        worker.lastProgress = FarmClock::now();
+
+        // First copy wins; late duplicates from re-issued tiles are dropped
+        if (!tiles[tile.id].done) {
+            const Uint8* rgb = payload + sizeof(FarmTile);
+            for (int y = tile.y0; y < tile.y1; ++y) {
+                for (int x = tile.x0; x < tile.x1; ++x) {
+                    image[y * job.width + x] = Color(int(rgb[0]), int(rgb[1]), int(rgb[2]));
+                    rgb += 3;
+                }
+            }
+            tiles[tile.id].done = true;
+            tilesDone++;
+        }
+    };
+
+    while (tilesDone < tiles.size()) {
+        // Hand out tiles to every ready worker with room in its pipeline
+        for (WorkerProcess& worker : workers) {
+            while (worker.alive && worker.ready && static_cast<int>(worker.inFlight.size()) < options.tilesInFlight) {
+                int next = -1;
+                while (!pending.empty() && next < 0) {
+                    int candidate = pending.front();
+                    pending.pop_front();
+                    if (!tiles[candidate].done) next = candidate;
+                }
+
+                // Nothing left to hand out: back up the oldest straggler
+                if (next < 0 && averageTileSeconds > 0.0) {
+                    double threshold = std::max(0.05, averageTileSeconds * options.reissueFactor);
+                    FarmClock::time_point oldest = FarmClock::now();
+                    for (const WorkerProcess& other : workers) {
+                        if (&other == &worker) continue;
+                        for (const Assignment& a : other.inFlight) {
+                            double elapsed = std::chrono::duration<double>(FarmClock::now() - a.start).count();
+                            if (!tiles[a.tile].done && tiles[a.tile].issued < 2 && elapsed > threshold && a.start < oldest) {
+                                oldest = a.start;
+                                next = a.tile;
+                            }
+                        }
+                    }
+                }
+                if (next < 0) break;
+
+                if (!sendMessage(worker.fd, FARM_TILE, &tiles[next].tile, sizeof(FarmTile))) {
+                    pending.push_front(next);
+                    retire(worker, "stopped accepting work");
+                    break;
+                }
+                if (worker.inFlight.empty()) worker.lastProgress = FarmClock::now();
+                tiles[next].issued++;
+                worker.inFlight.push_back({next, FarmClock::now()});
+
+                // Killed on dispatch, so it always dies holding at least this tile
+                if (&worker == &workers[0] && ++worker.tilesSent == options.killWorkerAfter) {
+                    retire(worker, "killed by --farm-kill-worker");
+                    break;
+                }
+            }
+        }
+
+        std::vector<pollfd> pollFds;
+        std::vector<int> pollWorkers;
+        for (int i = 0; i < static_cast<int>(workers.size()); ++i) {
+            if (!workers[i].alive) continue;
+            pollFds.push_back({workers[i].fd, POLLIN, 0});
+            pollWorkers.push_back(i);
+        }
+        if (pollFds.empty()) {
+            std::cerr << "farm: all workers died with " << tiles.size() - tilesDone << " tile(s) left" << std::endl;
+            return false;
+        }
+
+        int ready = poll(pollFds.data(), pollFds.size(), 100);
+        if (ready < 0 && errno != EINTR) {
+            std::cerr << "farm: poll failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (size_t p = 0; ready > 0 && p < pollFds.size(); ++p) {
+            if (pollFds[p].revents == 0) continue;
+            WorkerProcess& worker = workers[pollWorkers[p]];
+            bool open = receiveAvailable(worker.fd, worker.inbox);
+
+            // Handle every complete message; a partial one waits for the next poll
+            size_t consumed = 0;
+            while (worker.alive && worker.inbox.size() - consumed >= sizeof(FarmMessageHeader)) {
+                FarmMessageHeader header;
+                std::memcpy(&header, worker.inbox.data() + consumed, sizeof(header));
+                if (header.size > maxMessageSize) {
+                    retire(worker, "sent a bad message");
+                    break;
+                }
+                if (worker.inbox.size() - consumed - sizeof(header) < header.size) break;
+                const Uint8* payload = worker.inbox.data() + consumed + sizeof(header);
+                consumed += sizeof(header) + header.size;
+                handleMessage(worker, header, payload);
+            }
+
+            if (worker.alive) {
+                worker.inbox.erase(worker.inbox.begin(), worker.inbox.begin() + consumed);
+                if (!open) retire(worker, "exited");
+            } else {
+                worker.inbox.clear();
+            }
+        }
+
+        // Workers that stopped making progress are presumed hung
+        for (WorkerProcess& worker : workers) {
+            if (!worker.alive || (worker.ready && worker.inFlight.empty())) continue;
+            double silent = std::chrono::duration<double>(FarmClock::now() - worker.lastProgress).count();
+            if (silent > options.workerTimeout) {
+                retire(worker, "timed out");
+            }
+        }
+    }
+
+    for (WorkerProcess& worker : workers) {
+        if (worker.alive) {
+            // A worker still busy with a duplicated tile may be hung; do not wait on it
+            if (!worker.inFlight.empty()) {
+                kill(worker.pid, SIGKILL);
+            } else {
+                sendMessage(worker.fd, FARM_QUIT);
+            }
+            close(worker.fd);
+        }
+    }
+
+    // Give the workers a moment to exit; one that does not is hung (or stopped)
+    auto deadline = FarmClock::now() + std::chrono::seconds(2);
+    for (WorkerProcess& worker : workers) {
+        if (worker.pid <= 0) continue;
+        while (waitpid(worker.pid, nullptr, WNOHANG) == 0) {
+            if (FarmClock::now() > deadline) {
+                kill(worker.pid, SIGKILL);
+                waitpid(worker.pid, nullptr, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    return tilesDone == tiles.size();
+}
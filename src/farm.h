@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "color.h"
+
+// Distributed render mode. The coordinator splits the frame into tiles and
+// hands them to worker processes (this same executable started with
+// --farm-worker) over Unix socket pairs. Workers load the scene themselves
+// and stream the traced pixels back. Only POSIX calls are used, so it runs
+// on Linux and macOS alike.
+
+// Everything a worker needs to reproduce the frame. Sent as raw bytes, so it
+// must stay trivially copyable.
+struct FarmJob {
+    int width;
+    int height;
+    float fov;
+    float time;  // animation time
+    glm::vec3 cameraPosition;
+    glm::vec3 cameraTarget;
+    glm::vec3 cameraUp;
+    glm::vec3 lightPosition;
+};
+
+struct FarmTile {
+    int id;
+    int x0, y0;  // inclusive
+    int x1, y1;  // exclusive
+
+    int pixelCount() const { return (x1 - x0) * (y1 - y0); }
+};
+
+struct FarmOptions {
+    int workerCount = 4;
+    int tileSize = 32;
+    int tilesInFlight = 2;        // per worker, hides the round trip
+    float reissueFactor = 4.0f;   // duplicate a tile running this many times longer than the average tile
+    float workerTimeout = 60.0f;  // seconds without progress before a worker is killed
+
+    // Program the workers run, normally main's argv[0]. The workers inherit
+    // the working directory, so a relative path still resolves, and a bare
+    // name is looked up in PATH like the shell did.
+    std::string workerExecutable;
+
+    // Extra command line flags for the worker processes, for options that
+    // change how the scene is loaded (e.g. --compress-textures)
+    std::vector<std::string> workerArgs;
+
+    // Fault injection for testing on one host
+    int killWorkerAfter = -1;     // SIGKILL worker 0 when it is handed its Nth tile
+    int slowWorkerDelayMs = 0;    // worker 1 sleeps this long before every tile
+};
+
+using FarmJobSetup = std::function<void(const FarmJob&)>;
+using FarmTileRenderer = std::function<void(const FarmTile&, std::vector<Color>&)>;
+
+// Renders job into image (width * height, row major). Returns false if every
+// worker died before the frame was complete.
+bool runFarmCoordinator(const FarmOptions& options, const FarmJob& job, std::vector<Color>& image);
+
+// Worker side of the protocol on an inherited socket. setup runs once per
+// job, render fills one tile. Returns the process exit code.
+int runFarmWorker(int fd, int delayMs, const FarmJobSetup& setup, const FarmTileRenderer& render);
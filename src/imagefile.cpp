@@ -0,0 +1,44 @@
+#include "imagefile.h"
+#include <fstream>
+
+bool writePPM(const std::string& path, int width, int height, const std::vector<Color>& pixels) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Unable to write image: " << path << std::endl;
+        return false;
+    }
+
+    file << "P6\n" << width << " " << height << "\n255\n";
+    std::vector<Uint8> row(static_cast<size_t>(width) * 3);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const Color& c = pixels[y * width + x];
+            row[x * 3 + 0] = c.r;
+            row[x * 3 + 1] = c.g;
+            row[x * 3 + 2] = c.b;
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    return static_cast<bool>(file);
+}
+
+bool readPPM(const std::string& path, int& width, int& height, std::vector<Color>& pixels) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    std::string magic;
+    int maxValue = 0;
+    file >> magic >> width >> height >> maxValue;
+    file.get();  // single whitespace before the pixel data
+    if (!file || magic != "P6" || maxValue != 255 || width <= 0 || height <= 0) return false;
+
+    std::vector<Uint8> rgb(static_cast<size_t>(width) * height * 3);
+    file.read(reinterpret_cast<char*>(rgb.data()), rgb.size());
+    if (!file) return false;
+
+    pixels.resize(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = Color(int(rgb[i * 3]), int(rgb[i * 3 + 1]), int(rgb[i * 3 + 2]));
+    }
+    return true;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "color.h"
+
+// Binary PPM (P6), 8 bits per channel. Pixels are row major, alpha is dropped.
+bool writePPM(const std::string& path, int width, int height, const std::vector<Color>& pixels);
+
+// Reads a binary PPM written by writePPM. Returns false if the file is
+// missing or not an 8-bit P6 image.
+bool readPPM(const std::string& path, int& width, int& height, std::vector<Color>& pixels);
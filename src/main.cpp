@@ -1,6 +1,11 @@
 #include <SDL2/SDL.h>
 #include <glm/geometric.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 #include <print.h>
 #include <SDL_image.h>
@@ -12,18 +17,35 @@
 #include "camera.h"
 #include "cube.h"
 #include "skybox.h"
+#include "accel.h"
+#include "animation.h"
+#include "assets.h"
+#include "visibility.h"
+#include "farm.h"
+#include "imagefile.h"
+#include "exporter.h"
+#include "regression.h"
 
 
 const int SCREEN_WIDTH = 700;
 const int SCREEN_HEIGHT = 600;
 const float ASPECT_RATIO = static_cast<float>(SCREEN_WIDTH) / static_cast<float>(SCREEN_HEIGHT);
+const float FOV = 3.1415/3;
 const int MAX_RECURSION = 3;
 const float BIAS = 0.0001f;
 glm::vec3 lightOffset(0.0f, 2.0f, -1.0f);  // Ejemplo de desplazamiento
 Skybox skybox("../assets/ocean.png");
+bool compressTextures = false;
+std::unique_ptr<AssetLoader> assets;  // created by setUp(), its pool threads start there
 
 SDL_Renderer* renderer;
 std::vector<Object*> objects;
+std::vector<AnimationTrack> animations;
+SceneAccel accel;
+VisibilityBuffer visibility;
+bool useVisibilityPass = true;
+std::vector<Color> framebuffer(SCREEN_WIDTH * SCREEN_HEIGHT);
+uint64_t rayCount = 0;  // primary, secondary and shadow rays traced
 Light light(glm::vec3(-1.0, 0, 10), 1.0f, Color(255, 255, 255));
 Camera camera(glm::vec3(0.0, 0.0, 8.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 10.0f);
 
@@ -34,119 +56,130 @@ void point(glm::vec2 position, Color color) {
 }
 
 float castShadow(const glm::vec3& shadowOrigin, const glm::vec3& lightDir, Object* hitObject) {
-    for (auto& obj : objects) {
-        if (obj != hitObject) {
-            Intersect shadowIntersect = obj->rayIntersect(shadowOrigin, lightDir);
-            if (shadowIntersect.isIntersecting && shadowIntersect.dist > 0) {
-                float shadowRatio = shadowIntersect.dist / glm::length(light.position - shadowOrigin);
-                shadowRatio = glm::min(1.0f, shadowRatio);
-                return 1.0f - shadowRatio;
-            }
-        }
+    rayCount++;
+    SceneHit shadowHit;
+    if (accel.intersectShadow(shadowOrigin, lightDir, hitObject, shadowHit)) {
+        float shadowRatio = shadowHit.intersect.dist / glm::length(light.position - shadowOrigin);
+        shadowRatio = glm::min(1.0f, shadowRatio);
+        return 1.0f - shadowRatio;
     }
     return 1.0f;
 }
 
-Color getColorFromSurface(SDL_Surface* surface, float u, float v) {
-    if (surface == nullptr) return Color(0, 0, 0); // Retornar color negro en caso de no haber textura
-
-    u = fmod(u, 1.0f);
-    v = fmod(v, 1.0f);
-    if (u < 0) u += 1.0f;
-    if (v < 0) v += 1.0f;
-
-    int x = static_cast<int>(u * surface->w);
-    int y = static_cast<int>(v * surface->h);
-
-    Uint32 pixel = static_cast<Uint32*>(surface->pixels)[y * surface->w + x];
-    SDL_Color color;
-    SDL_GetRGB(pixel, surface->format, &color.r, &color.g, &color.b);
-    return Color(color.r, color.g, color.b);
-}
-
-
-Color castRay(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const short recursion = 0) {
-    float zBuffer = 99999;
-    Object* hitObject = nullptr;
-    Intersect intersect;
-
-    for (const auto& object : objects) {
-        Intersect i = object->rayIntersect(rayOrigin, rayDirection);
-        if (i.isIntersecting && i.dist < zBuffer) {
-            zBuffer = i.dist;
-            hitObject = object;
-            intersect = i;
-        }
-    }
-
-    if (!intersect.isIntersecting || recursion >= MAX_RECURSION) {
-        return skybox.getColor(rayDirection);  // Sky color
-    }
+Color castRay(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const short recursion = 0);
 
+// Shading specialized per material kernel (see shading.h): branches for
+// features the material does not have are compiled out.
+template <int Kernel>
+Color shadeKernel(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, Object* hitObject, const Intersect& intersect, const short recursion) {
+    constexpr bool reflective = (Kernel & FEATURE_REFLECTIVE) != 0;
+    constexpr bool transparent = (Kernel & FEATURE_TRANSPARENT) != 0;
+    constexpr bool textured = (Kernel & FEATURE_TEXTURED) != 0;
+    constexpr int specular = Kernel >> SPECULAR_SHIFT;
 
+    const Material& mat = hitObject->material;
 
     glm::vec3 lightDir = glm::normalize(light.position - intersect.point);
     glm::vec3 viewDir = glm::normalize(rayOrigin - intersect.point);
-    glm::vec3 reflectDir = glm::reflect(-lightDir, intersect.normal); 
+    glm::vec3 reflectDir = glm::reflect(-lightDir, intersect.normal);
 
     float shadowIntensity = castShadow(intersect.point, lightDir, hitObject);
 
     float diffuseLightIntensity = std::max(0.0f, glm::dot(intersect.normal, lightDir));
-    float specReflection = glm::dot(viewDir, reflectDir);
-    
-    Material mat = hitObject->material;
+    float specLightIntensity = specularPower<specular>(std::max(0.0f, glm::dot(viewDir, reflectDir)), mat.specularCoefficient);
 
-    float specLightIntensity = std::pow(std::max(0.0f, glm::dot(viewDir, reflectDir)), mat.specularCoefficient);
+    Color diffusecolor;
+    if constexpr (textured) {
+        diffusecolor = mat.texture->getColor(intersect.tx, intersect.ty);
+    } else {
+        diffusecolor = mat.diffuse;
+    }
 
+    Color diffuseLight = diffusecolor * light.intensity * diffuseLightIntensity * mat.albedo * shadowIntensity;
+    Color specularLight = light.color * light.intensity * specLightIntensity * mat.specularAlbedo * shadowIntensity;
+    Color color = (diffuseLight + specularLight) * (1.0f - mat.reflectivity - mat.transparency);
 
-    Color reflectedColor(0.0f, 0.0f, 0.0f);
-    if (mat.reflectivity > 0) {
+    if constexpr (reflective) {
         glm::vec3 origin = intersect.point + intersect.normal * BIAS;
-        reflectedColor = castRay(origin, reflectDir, recursion + 1); 
+        Color reflectedColor = castRay(origin, reflectDir, recursion + 1);
+        color = color + reflectedColor * mat.reflectivity;
     }
 
-    Color refractedColor(0.0f, 0.0f, 0.0f);
-    if (mat.transparency > 0) {
+    if constexpr (transparent) {
         glm::vec3 origin = intersect.point - intersect.normal * BIAS;
         glm::vec3 refractDir = glm::refract(rayDirection, intersect.normal, mat.refractionIndex);
-        refractedColor = castRay(origin, refractDir, recursion + 1); 
+        Color refractedColor = castRay(origin, refractDir, recursion + 1);
+        color = color + refractedColor * mat.transparency;
     }
 
-    Color diffusecolor ;
-    if (mat.texture != nullptr) {
-        diffusecolor = getColorFromSurface(mat.texture, intersect.tx, intersect.ty);
-    } else {
-        diffusecolor = mat.diffuse;
-    }
-
-    Color diffuseLight = diffusecolor * light.intensity * diffuseLightIntensity * mat.albedo * shadowIntensity;
-    Color specularLight = light.color * light.intensity * specLightIntensity * mat.specularAlbedo * shadowIntensity;
-    Color color = (diffuseLight + specularLight) * (1.0f - mat.reflectivity - mat.transparency) + reflectedColor * mat.reflectivity + refractedColor * mat.transparency;
     return color;
 }
 
-SDL_Surface* loadTexture(const std::string& file) {
-    SDL_Surface* surface = IMG_Load(file.c_str());
-    if (surface == nullptr) {
-        std::cerr << "Unable to load image: " << IMG_GetError() << std::endl;
+using ShadeKernel = Color (*)(const glm::vec3&, const glm::vec3&, Object*, const Intersect&, const short);
+
+template <int... Kernels>
+constexpr std::array<ShadeKernel, sizeof...(Kernels)> makeShadeKernels(std::integer_sequence<int, Kernels...>) {
+    return {&shadeKernel<Kernels>...};
+}
+
+const std::array<ShadeKernel, SHADING_KERNEL_COUNT> shadeKernels =
+    makeShadeKernels(std::make_integer_sequence<int, SHADING_KERNEL_COUNT>());
+
+Color shade(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, Object* hitObject, const Intersect& intersect, const short recursion) {
+    return shadeKernels[hitObject->shadingKernel](rayOrigin, rayDirection, hitObject, intersect, recursion);
+}
+
+Color castRay(const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const short recursion) {
+    rayCount++;
+    SceneHit hit;
+    accel.intersect(rayOrigin, rayDirection, hit);
+
+    if (!hit.intersect.isIntersecting || recursion >= MAX_RECURSION) {
+        return skybox.getColor(rayDirection);  // Sky color
     }
-    return surface;
+
+    return shade(rayOrigin, rayDirection, hit.object, hit.intersect, recursion);
 }
 
+// Primary ray through pixel (x, y). Uses the visibility buffer to skip the
+// traversal when the rasterized candidate is provably the nearest hit.
+Color castPrimaryRay(const glm::vec3& rayOrigin, int x, int y) {
+    const glm::vec3& rayDirection = visibility.direction(x, y);
+    const VisibilitySample& sample = visibility.at(x, y);
+
+    // Counted here only when resolved here; the fallback counts itself in castRay
+    if (sample.candidate < 0) {
+        rayCount++;
+        return skybox.getColor(rayDirection);
+    }
+
+    Object* candidate = objects[sample.candidate];
+    Intersect intersect = candidate->rayIntersect(rayOrigin, rayDirection);
+    if (intersect.isIntersecting && intersect.dist < sample.secondEntry) {
+        rayCount++;
+        return shade(rayOrigin, rayDirection, candidate, intersect, 0);
+    }
+
+    return castRay(rayOrigin, rayDirection);
+}
 
 void setUp() {
 
-    SDL_Surface* textureSurface = loadTexture("../assets/face.png");
-    SDL_Surface* skinFace = loadTexture("../assets/skin.png");
-    SDL_Surface* chestFace = loadTexture("../assets/collar.png");
-    SDL_Surface* dress = loadTexture("../assets/dress.png");
-    SDL_Surface * tail = loadTexture("../assets/tail.png");
-    SDL_Surface * hair = loadTexture("../assets/hair.png");
+    // Se cargan en paralelo; mientras tanto cada textura muestra su color aproximado
+    assets = std::make_unique<AssetLoader>(compressTextures);
+    skybox.load(*assets);
 
-    SDL_Surface * faceFish = loadTexture("../assets/facefish.png");
-    SDL_Surface * bodyFish = loadTexture("../assets/bodyfish.png");
+    Texture* textureSurface = assets->load("../assets/face.png", Color(230, 200, 190));
+    Texture* skinFace = assets->load("../assets/skin.png", Color(255, 240, 230));
+    Texture* chestFace = assets->load("../assets/collar.png", Color(240, 220, 200));
+    Texture* dress = assets->load("../assets/dress.png", Color(40, 130, 120));
+    Texture * tail = assets->load("../assets/tail.png", Color(150, 220, 210));
+    Texture * hair = assets->load("../assets/hair.png", Color(50, 50, 130));
 
-    SDL_Surface * trident = loadTexture("../assets/trident.png");
+    Texture * faceFish = assets->load("../assets/facefish.png", Color(235, 170, 40));
+    Texture * bodyFish = assets->load("../assets/bodyfish.png", Color(225, 150, 30));
+
+    Texture * trident = assets->load("../assets/trident.png", Color(120, 60, 180));
 
     Material faceMaterial = {
         Color(0, 0, 0),
@@ -296,9 +329,11 @@ void setUp() {
 
 
     //pez cara
+    size_t fishFirst = objects.size();
     objects.push_back(new Cube(glm::vec3(3.0f, -2.0f, 0.0f), 1.2f, facefishMaterial));
 
     //burbujas
+    size_t bubblesFirst = objects.size();
     objects.push_back(new Sphere(glm::vec3(3.0f, -2.0f, 1.0f), 0.2f, mirror));
     objects.push_back(new Sphere(glm::vec3(3.0f, -2.0f, 2.0f), 0.2f, mirror));
     objects.push_back(new Sphere(glm::vec3(3.0f, -1.5f, 1.5f), 0.1f, mirror));
@@ -308,6 +343,7 @@ void setUp() {
     objects.push_back(new Cube(glm::vec3(3.0f, -1.5f, 0.0f), 0.7f, bodyfishMaterial));
     objects.push_back(new Cube(glm::vec3(2.6f, -2.0f, 0.0f), 0.9f, bodyfishMaterial));
     objects.push_back(new Cube(glm::vec3(3.4f, -2.0f, 0.0f), 0.9f, bodyfishMaterial));
+    size_t fishLast = objects.size();
 
     //trident
     objects.push_back(new Cube(glm::vec3(0.8f, -1.2f, -0.6f), 0.2f, greeneMaterial));
@@ -333,36 +369,285 @@ void setUp() {
     objects.push_back(new Cube(glm::vec3(0.4f, -1.2f, 1.6f), 0.2f, tridentMaterial));
     objects.push_back(new Cube(glm::vec3(1.2f, -1.2f, 1.6f), 0.2f, tridentMaterial));
 
+    // animacion: el pez sube y baja, las burbujas flotan hacia arriba y crecen
+    std::vector<Keyframe> swim = {
+        {0.0f, glm::vec3(0.0f, 0.0f, 0.0f)},
+        {2.0f, glm::vec3(0.0f, 0.4f, 0.0f)},
+        {4.0f, glm::vec3(0.0f, 0.0f, 0.0f)}
+    };
+    for (size_t i = fishFirst; i < fishLast; ++i) {
+        if (i >= bubblesFirst && i < bubblesFirst + 3) continue;
+        animations.emplace_back(objects[i], swim);
+    }
+
+    float bubbleDurations[] = {3.0f, 3.5f, 2.5f};
+    for (int i = 0; i < 3; ++i) {
+        animations.emplace_back(objects[bubblesFirst + i], std::vector<Keyframe>{
+            {0.0f, glm::vec3(0.0f, 0.0f, 0.0f), 1.0f},
+            {bubbleDurations[i], glm::vec3(0.0f, 2.5f, 0.0f), 1.4f}
+        });
+    }
+
+    accel.build(objects);
+}
+
+// Traces one frame into pixels (rays.width * rays.height, row major)
+void renderFrame(const RayGenerator& rays, std::vector<Color>& pixels) {
+    if (useVisibilityPass) {
+        visibility.build(objects, rays);
+    }
+
+    for (int y = 0; y < rays.height; y++) {
+        for (int x = 0; x < rays.width; x++) {
+            pixels[y * rays.width + x] = useVisibilityPass
+                ? castPrimaryRay(rays.origin, x, y)
+                : castRay(rays.origin, rays.direction(x, y));
+        }
+    }
 }
 
 void render() {
-    float fov = 3.1415/3;
+    RayGenerator rays(camera, FOV, SCREEN_WIDTH, SCREEN_HEIGHT);
+    renderFrame(rays, framebuffer);
+
     for (int y = 0; y < SCREEN_HEIGHT; y++) {
         for (int x = 0; x < SCREEN_WIDTH; x++) {
+            point(glm::vec2(x, y), framebuffer[y * SCREEN_WIDTH + x]);
+        }
+    }
+}
 
-            float screenX = (2.0f * (x + 0.5f)) / SCREEN_WIDTH - 1.0f;
-            float screenY = -(2.0f * (y + 0.5f)) / SCREEN_HEIGHT + 1.0f;
-            screenX *= ASPECT_RATIO;
-            screenX *= tan(fov/2.0f);
-            screenY *= tan(fov/2.0f);
-
+// Renders every frame of a camera path straight to disk. The FrameWriter
+// encodes and writes frame N on its own thread while frame N + 1 is traced.
+int exportCameraPath(const std::vector<CameraKeyframe>& path, FrameWriter::Format format, const std::string& output,
+                     int width, int height, float fps) {
+    // Fail before loading the scene if the output cannot be created
+    FrameWriter writer(format, output, width, height);
+    if (!writer.ok()) {
+        return 1;
+    }
 
-            glm::vec3 cameraDir = glm::normalize(camera.target - camera.position);
+    setUp();
+    assets->wait();  // every frame has to use the final textures
 
-            glm::vec3 cameraX = glm::normalize(glm::cross(cameraDir, camera.up));
-            glm::vec3 cameraY = glm::normalize(glm::cross(cameraX, cameraDir));
-            glm::vec3 rayDirection = glm::normalize(
-                cameraDir + cameraX * screenX + cameraY * screenY
-            );
-           
-            Color pixelColor = castRay(camera.position, rayDirection);
+    int frames = cameraPathLength(path);
+    Uint32 startTime = SDL_GetTicks();
 
-            point(glm::vec2(x, y), pixelColor);
+    for (int frame = 0; frame < frames; ++frame) {
+        stepCameraPath(camera, path, frame);
+        light.position = camera.position + lightOffset;
+        for (const auto& track : animations) {
+            track.apply(frame / fps);
         }
+        accel.update();
+
+        std::vector<Color> pixels = writer.acquireBuffer();
+        renderFrame(RayGenerator(camera, FOV, width, height), pixels);
+        writer.submit(std::move(pixels));
     }
+
+    if (!writer.finish()) {
+        return 1;
+    }
+    print("Exported", frames, "frames to", output, "in", (SDL_GetTicks() - startTime) / 1000.0f, "s");
+    return 0;
+}
+
+// Renders one regression pose from the starting camera and restores it afterwards.
+// Best of two runs, so a single scheduler hiccup does not blow the time budget.
+RegressionRun renderRegressionPose(int width, int height, float rotate, float move, float time, bool visibilityPass) {
+    Camera savedCamera = camera;
+    glm::vec3 savedLight = light.position;
+    bool savedVisibilityPass = useVisibilityPass;
+
+    camera.rotate(rotate, 0.0f);
+    camera.move(move);
+    light.position = camera.position + lightOffset;
+    for (const auto& track : animations) {
+        track.apply(time);
+    }
+    accel.update();
+    useVisibilityPass = visibilityPass;
+
+    RegressionRun run = {std::vector<Color>(static_cast<size_t>(width) * height), 0.0, 0};
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        rayCount = 0;
+        auto start = std::chrono::steady_clock::now();
+        renderFrame(RayGenerator(camera, FOV, width, height), run.image);
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        run.milliseconds = attempt == 0 ? milliseconds : std::min(run.milliseconds, milliseconds);
+        run.rays = rayCount;
+    }
+
+    camera = savedCamera;
+    light.position = savedLight;
+    useVisibilityPass = savedVisibilityPass;
+    return run;
+}
+
+// Fixed poses of the mermaid scene checked by the regression test (ctest)
+int runRegression(const std::string& dir, bool bless) {
+    const int width = 350;
+    const int height = 300;
+
+    setUp();
+    assets->wait();
+
+    auto pose = [&](float rotate, float move, float time, bool visibilityPass) {
+        return [=]() { return renderRegressionPose(width, height, rotate, move, time, visibilityPass); };
+    };
+    std::vector<RegressionScenario> scenarios = {
+        {"front", "front", pose(0.0f, 0.0f, 0.0f, true)},
+        {"front_full_traversal", "front", pose(0.0f, 0.0f, 0.0f, false)},
+        {"orbit_left", "orbit_left", pose(-3.0f, 0.0f, 0.0f, true)},
+        {"orbit_right_fish", "orbit_right_fish", pose(4.0f, 0.0f, 1.0f, true)},
+        {"close_up", "close_up", pose(0.0f, 3.0f, 0.0f, true)},
+        {"bubbles_rising", "bubbles_rising", pose(2.0f, 1.0f, 2.0f, true)},
+    };
+
+    return runRegressionSuite(dir, bless, width, height, scenarios);
+}
+
+// Worker process of the render farm: loads the scene and traces the tiles it is sent
+int runFarmWorkerProcess(int fd, int delayMs) {
+    setUp();
+    assets->wait();
+
+    FarmJob current{};
+    return runFarmWorker(fd, delayMs,
+        [&](const FarmJob& job) {
+            current = job;
+            camera.position = job.cameraPosition;
+            camera.target = job.cameraTarget;
+            camera.up = job.cameraUp;
+            light.position = job.lightPosition;
+            for (const auto& track : animations) {
+                track.apply(job.time);
+            }
+            accel.update();
+        },
+        [&](const FarmTile& tile, std::vector<Color>& pixels) {
+            RayGenerator rays(camera, current.fov, current.width, current.height);
+            int i = 0;
+            for (int y = tile.y0; y < tile.y1; y++) {
+                for (int x = tile.x0; x < tile.x1; x++) {
+                    pixels[i++] = castRay(rays.origin, rays.direction(x, y));
+                }
+            }
+        });
+}
+
+int usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--compress-textures] [--no-visibility-pass]\n"
+              << "    [--width N] [--height N]\n"
+              << "    [--farm WORKERS [--farm-output FILE] [--tile-size N] [--farm-kill-worker N] [--farm-slow-worker MS]]\n"
+              << "    [--export DIR | --export-raw FILE] [--camera-path FRAMES:ROTATE:MOVE,...] [--fps N]\n"
+              << "    [--regression DIR [--bless]]" << std::endl;
+    return 2;
 }
 
 int main(int argc, char* argv[]) {
+    FarmOptions farmOptions;
+    int farmWorkers = 0;
+    int farmWorkerFd = -1;
+    int farmWorkerDelay = 0;
+    std::string farmOutput = "farm.ppm";
+    int outputWidth = SCREEN_WIDTH;
+    int outputHeight = SCREEN_HEIGHT;
+    std::string exportOutput;
+    FrameWriter::Format exportFormat = FrameWriter::Format::ImageSequence;
+    std::string cameraPath = "120:18:0";  // one full turn: Camera::rotate turns 2 * rotationSpeed = 20 degrees per unit
+    float exportFps = 30.0f;
+    std::string regressionDir;
+    bool bless = false;
+
+    std::string arg;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--compress-textures") {
+                compressTextures = true;
+            } else if (arg == "--no-visibility-pass") {
+                useVisibilityPass = false;
+            } else if (arg == "--farm" && hasValue) {
+                farmWorkers = std::stoi(argv[++i]);
+            } else if (arg == "--farm-output" && hasValue) {
+                farmOutput = argv[++i];
+            } else if (arg == "--tile-size" && hasValue) {
+                farmOptions.tileSize = std::stoi(argv[++i]);
+            } else if (arg == "--width" && hasValue) {
+                outputWidth = std::stoi(argv[++i]);
+            } else if (arg == "--height" && hasValue) {
+                outputHeight = std::stoi(argv[++i]);
+            } else if (arg == "--farm-kill-worker" && hasValue) {
+                farmOptions.killWorkerAfter = std::stoi(argv[++i]);
+            } else if (arg == "--farm-slow-worker" && hasValue) {
+                farmOptions.slowWorkerDelayMs = std::stoi(argv[++i]);
+            } else if (arg == "--export" && hasValue) {
+                exportOutput = argv[++i];
+                exportFormat = FrameWriter::Format::ImageSequence;
+            } else if (arg == "--export-raw" && hasValue) {
+                exportOutput = argv[++i];
+                exportFormat = FrameWriter::Format::RawVideo;
+            } else if (arg == "--camera-path" && hasValue) {
+                cameraPath = argv[++i];
+            } else if (arg == "--fps" && hasValue) {
+                exportFps = std::stof(argv[++i]);
+            } else if (arg == "--regression" && hasValue) {
+                regressionDir = argv[++i];
+            } else if (arg == "--bless") {
+                bless = true;
+            } else if (arg == "--farm-worker" && hasValue) {
+                farmWorkerFd = std::stoi(argv[++i]);
+            } else if (arg == "--farm-worker-delay" && hasValue) {
+                farmWorkerDelay = std::stoi(argv[++i]);
+            }
+        }
+    } catch (const std::logic_error&) {
+        // std::stoi / std::stof throw invalid_argument or out_of_range
+        std::cerr << "Invalid number after " << arg << std::endl;
+        return usage(argv[0]);
+    }
+
+    if (outputWidth <= 0 || outputHeight <= 0 || farmOptions.tileSize <= 0 || exportFps <= 0.0f) {
+        std::cerr << "--width, --height, --tile-size and --fps must be greater than zero" << std::endl;
+        return usage(argv[0]);
+    }
+
+    if (farmWorkerFd >= 0) {
+        return runFarmWorkerProcess(farmWorkerFd, farmWorkerDelay);
+    }
+
+    if (!regressionDir.empty()) {
+        return runRegression(regressionDir, bless);
+    }
+
+    if (!exportOutput.empty()) {
+        std::vector<CameraKeyframe> path = parseCameraPath(cameraPath);
+        if (path.empty()) {
+            return 1;
+        }
+        return exportCameraPath(path, exportFormat, exportOutput, outputWidth, outputHeight, exportFps);
+    }
+
+    if (farmWorkers > 0) {
+        // Offline render of the current camera on worker processes, no window
+        farmOptions.workerCount = farmWorkers;
+        farmOptions.workerExecutable = argv[0];
+        if (compressTextures) {
+            farmOptions.workerArgs.push_back("--compress-textures");
+        }
+        FarmJob job = {outputWidth, outputHeight, FOV, 0.0f,
+                      camera.position, camera.target, camera.up, light.position};
+        std::vector<Color> image;
+        if (!runFarmCoordinator(farmOptions, job, image) || !writePPM(farmOutput, outputWidth, outputHeight, image)) {
+            return 1;
+        }
+        print("Farm render written to", farmOutput);
+        return 0;
+    }
+
     // Initialize SDL
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         SDL_Log("Unable to initialize SDL: %s", SDL_GetError());
@@ -422,6 +707,9 @@ int main(int argc, char* argv[]) {
                     case SDLK_RIGHT:
                         camera.rotate(1.0f, 0.0f);
                         break;
+                    case SDLK_v:
+                        useVisibilityPass = !useVisibilityPass;
+                        break;
 
                  }
                 light.position = camera.position + lightOffset;
@@ -430,6 +718,13 @@ int main(int argc, char* argv[]) {
 
         }
 
+        // Move the animated objects and refit the acceleration structure
+        float animationTime = (SDL_GetTicks() - startTime) / 1000.0f;
+        for (const auto& track : animations) {
+            track.apply(animationTime);
+        }
+        accel.update();
+
         // Clear the screen
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
@@ -445,6 +740,9 @@ int main(int argc, char* argv[]) {
         if (SDL_GetTicks() - currentTime >= 1000) {
             currentTime = SDL_GetTicks();
             std::string title = "Kosirena - FPS: " + std::to_string(frameCount);
+            if (assets->pending() > 0) {
+                title += " - loading " + std::to_string(assets->pending()) + " textures";
+            }
             SDL_SetWindowTitle(window, title.c_str());
             frameCount = 0;
         }
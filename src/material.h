@@ -11,5 +11,5 @@ struct Material {
   float reflectivity;
   float transparency;
   float refractionIndex;
-  SDL_Surface* texture;
+  Texture* texture;
 };
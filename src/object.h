@@ -3,11 +3,18 @@
 #include <glm/glm.hpp>
 #include "material.h"
 #include "intersect.h"
+#include "transform.h"
+#include "aabb.h"
+#include "shading.h"
 
 class Object {
 public:
-  Object(const Material& mat) : material(mat) {}
+  Object(const Material& mat) : material(mat), shadingKernel(classifyMaterial(mat)) {}
   virtual Intersect rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const = 0;
-  
+  virtual AABB getBounds() const = 0;
+
   Material material;
+  int shadingKernel;
+  Transform transform;
+  bool dynamic = false;  // animated objects go to the refit level of the BVH
 };
@@ -0,0 +1,173 @@
+#include "regression.h"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include "imagefile.h"
+
+struct RegressionBudget {
+    double milliseconds;
+    uint64_t rays;
+};
+
+static std::map<std::string, RegressionBudget> readBudgets(const std::string& path) {
+    std::map<std::string, RegressionBudget> budgets;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        RegressionBudget budget;
+        if (fields >> name >> budget.milliseconds >> budget.rays) {
+            budgets[name] = budget;
+        }
+    }
+    return budgets;
+}
+
+static bool writeBudgets(const std::string& path, const std::map<std::string, RegressionBudget>& budgets) {
+    std::ofstream file(path);
+    file << "# scenario  max_milliseconds  max_rays   (written by --regression --bless)\n";
+    for (const auto& [name, budget] : budgets) {
+        file << name << " " << budget.milliseconds << " " << budget.rays << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+// sRGB (8 bit) to CIE Lab with a D65 white point
+static void toLab(const Color& c, double lab[3]) {
+    auto linear = [](Uint8 v) {
+        double s = v / 255.0;
+        return s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+    };
+    double r = linear(c.r), g = linear(c.g), b = linear(c.b);
+    double xyz[3] = {
+        (0.4124 * r + 0.3576 * g + 0.1805 * b) / 0.95047,
+        (0.2126 * r + 0.7152 * g + 0.0722 * b) / 1.00000,
+        (0.0193 * r + 0.1192 * g + 0.9505 * b) / 1.08883
+    };
+    for (double& v : xyz) {
+        v = v > 0.008856 ? std::cbrt(v) : 7.787 * v + 16.0 / 116.0;
+    }
+    lab[0] = 116.0 * xyz[1] - 16.0;
+    lab[1] = 500.0 * (xyz[0] - xyz[1]);
+    lab[2] = 200.0 * (xyz[1] - xyz[2]);
+}
+
+ImageDifference compareImages(const std::vector<Color>& a, const std::vector<Color>& b, double pixelDeltaE) {
+    ImageDifference difference = {0.0, 0.0};
+    if (a.size() != b.size() || a.empty()) {
+        difference.meanDeltaE = 100.0;
+        difference.changedFraction = 1.0;
+        return difference;
+    }
+
+    size_t changed = 0;
+    double total = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].r == b[i].r && a[i].g == b[i].g && a[i].b == b[i].b) continue;
+        double labA[3], labB[3];
+        toLab(a[i], labA);
+        toLab(b[i], labB);
+        double deltaE = std::sqrt((labA[0] - labB[0]) * (labA[0] - labB[0]) +
+                                  (labA[1] - labB[1]) * (labA[1] - labB[1]) +
+                                  (labA[2] - labB[2]) * (labA[2] - labB[2]));
+        total += deltaE;
+        if (deltaE > pixelDeltaE) changed++;
+    }
+    difference.meanDeltaE = total / a.size();
+    difference.changedFraction = static_cast<double>(changed) / a.size();
+    return difference;
+}
+
+int runRegressionSuite(const std::string& dir, bool bless, int width, int height,
+                       const std::vector<RegressionScenario>& scenarios,
+                       const RegressionTolerance& tolerance) {
+    namespace fs = std::filesystem;
+    const std::string budgetsPath = dir + "/budgets.txt";
+
+    if (bless) {
+        std::error_code error;
+        fs::create_directories(dir, error);
+    } else if (!fs::exists(budgetsPath)) {
+        std::cout << "No golden images in " << dir << ", record them with --regression " << dir << " --bless" << std::endl;
+        return REGRESSION_SKIPPED;
+    }
+
+    std::map<std::string, RegressionBudget> budgets = readBudgets(budgetsPath);
+    std::set<std::string> blessedGoldens;
+    int failures = 0;
+
+    for (const RegressionScenario& scenario : scenarios) {
+        RegressionRun run = scenario.render();
+        std::string goldenPath = dir + "/" + scenario.golden + ".ppm";
+        std::vector<std::string> problems;
+        char line[256];
+
+        // The first scenario using a golden records it; later ones are still compared
+        if (bless && blessedGoldens.insert(scenario.golden).second) {
+            if (!writePPM(goldenPath, width, height, run.image)) {
+                problems.push_back("could not write " + goldenPath);
+            }
+        }
+
+        int goldenWidth = 0, goldenHeight = 0;
+        std::vector<Color> golden;
+        ImageDifference difference = {0.0, 0.0};
+        if (!readPPM(goldenPath, goldenWidth, goldenHeight, golden)) {
+            problems.push_back("missing golden " + goldenPath);
+        } else if (goldenWidth != width || goldenHeight != height) {
+            problems.push_back("golden is " + std::to_string(goldenWidth) + "x" + std::to_string(goldenHeight));
+        } else {
+            difference = compareImages(run.image, golden, tolerance.pixelDeltaE);
+            if (difference.meanDeltaE > tolerance.maxMeanDeltaE) {
+                std::snprintf(line, sizeof(line), "mean delta E %.3f > %.3f", difference.meanDeltaE, tolerance.maxMeanDeltaE);
+                problems.push_back(line);
+            }
+            if (difference.changedFraction > tolerance.maxChangedFraction) {
+                std::snprintf(line, sizeof(line), "%.2f%% of pixels changed (max %.2f%%)",
+                              difference.changedFraction * 100.0, tolerance.maxChangedFraction * 100.0);
+                problems.push_back(line);
+            }
+        }
+
+        if (bless) {
+            budgets[scenario.name] = {run.milliseconds * tolerance.timeHeadroom + tolerance.timeSlackMs,
+                                      static_cast<uint64_t>(std::ceil(run.rays * tolerance.rayHeadroom))};
+        }
+
+        auto budget = budgets.find(scenario.name);
+        if (budget == budgets.end()) {
+            problems.push_back("no budget in " + budgetsPath);
+        } else {
+            if (run.milliseconds > budget->second.milliseconds) {
+                std::snprintf(line, sizeof(line), "took %.1f ms, budget %.1f ms", run.milliseconds, budget->second.milliseconds);
+                problems.push_back(line);
+            }
+            if (run.rays > budget->second.rays) {
+                problems.push_back("traced " + std::to_string(run.rays) + " rays, budget " + std::to_string(budget->second.rays));
+            }
+        }
+
+        std::snprintf(line, sizeof(line), "[%s] %-22s dE %.3f  changed %.3f%%  %.1f ms  %llu rays",
+                      problems.empty() ? (bless ? "BLESS" : "PASS") : "FAIL", scenario.name.c_str(),
+                      difference.meanDeltaE, difference.changedFraction * 100.0, run.milliseconds,
+                      static_cast<unsigned long long>(run.rays));
+        std::cout << line << std::endl;
+        for (const std::string& problem : problems) {
+            std::cout << "    " << problem << std::endl;
+        }
+        if (!problems.empty()) failures++;
+    }
+
+    if (bless && !writeBudgets(budgetsPath, budgets)) {
+        std::cout << "Could not write " << budgetsPath << std::endl;
+        failures++;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "color.h"
+
+// Golden-image regression suite. Every scenario renders headlessly and is
+// compared against <dir>/<golden>.ppm with a perceptual tolerance (CIE76
+// delta E in Lab space), then checked against the time and ray budgets in
+// <dir>/budgets.txt. --bless records new goldens and budgets.
+
+const int REGRESSION_SKIPPED = 77;  // CTest SKIP_RETURN_CODE: nothing blessed yet
+
+struct RegressionRun {
+    std::vector<Color> image;
+    double milliseconds;
+    uint64_t rays;
+};
+
+struct RegressionScenario {
+    std::string name;
+    std::string golden;  // scenarios may share a golden when they must render the same image
+    std::function<RegressionRun()> render;
+};
+
+struct RegressionTolerance {
+    double maxMeanDeltaE = 1.0;        // average over the image
+    double pixelDeltaE = 10.0;         // a pixel beyond this counts as changed...
+    double maxChangedFraction = 0.005; // ...and at most this fraction may change
+    // Time budgets are committed with the goldens and have to hold on other
+    // machines and in unoptimized builds, so they only catch gross slowdowns.
+    // The ray budgets are the precise, machine independent check.
+    double timeHeadroom = 5.0;         // blessed budget = measured time * headroom + slack
+    double timeSlackMs = 500.0;
+    double rayHeadroom = 1.02;         // blessed budget = measured rays * headroom
+};
+
+struct ImageDifference {
+    double meanDeltaE;
+    double changedFraction;
+};
+
+ImageDifference compareImages(const std::vector<Color>& a, const std::vector<Color>& b, double pixelDeltaE);
+
+// Returns 0 when every scenario passes, 1 on any failure, or
+// REGRESSION_SKIPPED when no goldens exist yet.
+int runRegressionSuite(const std::string& dir, bool bless, int width, int height,
+                       const std::vector<RegressionScenario>& scenarios,
+                       const RegressionTolerance& tolerance = RegressionTolerance());
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cmath>
+#include "material.h"
+
+// Materials are classified once, when the object is created, into a
+// shading kernel id: three feature bits plus the way the specular term is
+// raised to specularCoefficient. castRay then jumps straight to a kernel
+// compiled for exactly that combination (see shadeKernels in main.cpp).
+enum MaterialFeature {
+    FEATURE_REFLECTIVE = 1,
+    FEATURE_TRANSPARENT = 2,
+    FEATURE_TEXTURED = 4
+};
+
+enum SpecularExponent {
+    SPECULAR_POW = 0,  // non-integer exponent, std::pow
+    SPECULAR_5,
+    SPECULAR_10,
+    SPECULAR_INT       // any other integer exponent, square-and-multiply
+};
+
+const int SPECULAR_SHIFT = 3;
+const int SHADING_KERNEL_COUNT = 4 << SPECULAR_SHIFT;
+
+inline int classifyMaterial(const Material& mat) {
+    int kernel = 0;
+    if (mat.reflectivity > 0) kernel |= FEATURE_REFLECTIVE;
+    if (mat.transparency > 0) kernel |= FEATURE_TRANSPARENT;
+    if (mat.texture != nullptr) kernel |= FEATURE_TEXTURED;
+
+    int specular = SPECULAR_POW;
+    float exponent = mat.specularCoefficient;
+    if (exponent == 5.0f) {
+        specular = SPECULAR_5;
+    } else if (exponent == 10.0f) {
+        specular = SPECULAR_10;
+    } else if (exponent >= 0.0f && exponent <= 65536.0f && exponent == std::floor(exponent)) {
+        specular = SPECULAR_INT;
+    }
+    return kernel | (specular << SPECULAR_SHIFT);
+}
+
+template <int N>
+inline float powInt(float x) {
+    if constexpr (N == 0) {
+        return 1.0f;
+    } else if constexpr (N % 2 == 0) {
+        float half = powInt<N / 2>(x);
+        return half * half;
+    } else {
+        return x * powInt<N - 1>(x);
+    }
+}
+
+inline float powInt(float x, int n) {
+    float result = 1.0f;
+    while (n > 0) {
+        if (n & 1) result *= x;
+        x *= x;
+        n >>= 1;
+    }
+    return result;
+}
+
+template <int Specular>
+inline float specularPower(float x, float exponent) {
+    if constexpr (Specular == SPECULAR_5) {
+        return powInt<5>(x);
+    } else if constexpr (Specular == SPECULAR_10) {
+        return powInt<10>(x);
+    } else if constexpr (Specular == SPECULAR_INT) {
+        return powInt(x, static_cast<int>(exponent));
+    } else {
+        return std::pow(x, exponent);
+    }
+}
@@ -3,15 +3,21 @@
 #include <string>
 #include <glm/glm.hpp>
 #include "color.h"
+#include "texture.h"
+
+class AssetLoader;
 
 class Skybox {
 public:
+    // Only remembers the file; the image is decoded later by load() so that
+    // nothing heavy runs during static initialization.
     Skybox(const std::string& textureFile);
-    ~Skybox();
+
+    void load(AssetLoader& loader);
 
     Color getColor(const glm::vec3& direction) const;
 
 private:
-    SDL_Surface* texture;
-    void loadTexture(const std::string& textureFile);
-};
\ No newline at end of file
+    std::string textureFile;
+    Texture texture;
+};
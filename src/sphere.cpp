@@ -4,6 +4,8 @@ Sphere::Sphere(const glm::vec3& center, float radius, const Material& mat)
   : center(center), radius(radius), Object(mat) {}
 
 Intersect Sphere::rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const {
+  glm::vec3 center = this->center + transform.translation;
+  float radius = this->radius * transform.scale;
   glm::vec3 oc = rayOrigin - center;
 
   float a = glm::dot(rayDirection, rayDirection);
@@ -27,4 +29,7 @@ Intersect Sphere::rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayD
   return Intersect{true, dist, point, normal};
 }
 
-
+AABB Sphere::getBounds() const {
+  glm::vec3 extent(radius * transform.scale);
+  return AABB(center + transform.translation - extent, center + transform.translation + extent);
+}
@@ -10,6 +10,7 @@ public:
   Sphere(const glm::vec3& center, float radius, const Material& mat);
 
   Intersect rayIntersect(const glm::vec3& rayOrigin, const glm::vec3& rayDirection) const override;
+  AABB getBounds() const override;
 
 private:
   glm::vec3 center;
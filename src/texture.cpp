@@ -0,0 +1,57 @@
+#include "texture.h"
+#include <cmath>
+
+Texture::Texture(Color placeholder) : placeholder(placeholder) {}
+
+Texture::~Texture() {
+    SDL_Surface* loaded = surface.load();
+    if (loaded != nullptr) {
+        SDL_FreeSurface(loaded);
+    }
+    delete compressed.load();
+}
+
+void Texture::setSurface(SDL_Surface* loaded) {
+    SDL_Surface* expected = nullptr;
+    if (!surface.compare_exchange_strong(expected, loaded, std::memory_order_acq_rel)) {
+        SDL_FreeSurface(loaded);
+    }
+}
+
+void Texture::setCompressed(std::unique_ptr<BlockCompressedImage> image) {
+    BlockCompressedImage* expected = nullptr;
+    if (compressed.compare_exchange_strong(expected, image.get(), std::memory_order_acq_rel)) {
+        image.release();
+    }
+}
+
+static Color texelFromSurface(const SDL_Surface* s, int x, int y) {
+    const Uint8* row = static_cast<const Uint8*>(s->pixels) + y * s->pitch;
+    Uint32 pixel = reinterpret_cast<const Uint32*>(row)[x];
+    // SDL_PIXELFORMAT_ARGB8888
+    return Color(int((pixel >> 16) & 0xFF), int((pixel >> 8) & 0xFF), int(pixel & 0xFF));
+}
+
+Color Texture::getColor(float u, float v) const {
+    u = std::fmod(u, 1.0f);
+    v = std::fmod(v, 1.0f);
+    if (u < 0) u += 1.0f;
+    if (v < 0) v += 1.0f;
+    // Degenerate rays (e.g. glm::refract on total internal reflection) give NaN coordinates
+    if (!(u >= 0.0f)) u = 0.0f;
+    if (!(v >= 0.0f)) v = 0.0f;
+
+    const BlockCompressedImage* image = compressed.load(std::memory_order_acquire);
+    if (image != nullptr) {
+        int x = std::min(static_cast<int>(u * image->getWidth()), image->getWidth() - 1);
+        int y = std::min(static_cast<int>(v * image->getHeight()), image->getHeight() - 1);
+        return image->getTexel(x, y);
+    }
+
+    const SDL_Surface* s = surface.load(std::memory_order_acquire);
+    if (s == nullptr) return placeholder;
+
+    int x = std::min(static_cast<int>(u * s->w), s->w - 1);
+    int y = std::min(static_cast<int>(v * s->h), s->h - 1);
+    return texelFromSurface(s, x, y);
+}
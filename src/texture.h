@@ -1,14 +1,35 @@
 #pragma once
 
-
+#include <atomic>
+#include <memory>
+#include <SDL2/SDL.h>
 #include "color.h"
+#include "blocktexture.h"
 
+// CPU-side texture sampled by the ray tracer. Until the asset loader
+// publishes the decoded surface, every lookup returns the placeholder color,
+// so rendering can start before the image has been decoded.
 class Texture {
 public:
-    SDL_Texture* sdlTexture;
-    Color getColor(float u, float v) {
-        // Implementación que devuelva un color basado en las coordenadas UV
-        // Esta parte es compleja porque SDL_Texture no permite acceso directo a píxeles
+    explicit Texture(Color placeholder = Color(128, 128, 128));
+    ~Texture();
+
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    // Takes ownership of a surface already converted to SDL_PIXELFORMAT_ARGB8888.
+    // A texture is published only once; later surfaces are freed and ignored
+    // because render threads may still be reading the first one.
+    void setSurface(SDL_Surface* surface);
+
+    // Same as setSurface but publishes a block compressed copy instead.
+    void setCompressed(std::unique_ptr<BlockCompressedImage> image);
+
+    // Wrapping nearest lookup with u, v in texture space.
+    Color getColor(float u, float v) const;
 
-    }
-};
\ No newline at end of file
+private:
+    std::atomic<SDL_Surface*> surface{nullptr};
+    std::atomic<BlockCompressedImage*> compressed{nullptr};
+    Color placeholder;
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Per-object transform. Cubes stay axis aligned, so only translation and
+// uniform scale are supported.
+struct Transform {
+    glm::vec3 translation = glm::vec3(0.0f);
+    float scale = 1.0f;
+};
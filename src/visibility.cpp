@@ -0,0 +1,81 @@
+#include "visibility.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void VisibilityBuffer::build(const std::vector<Object*>& objects, const RayGenerator& rays) {
+    width = rays.width;
+    height = rays.height;
+    samples.assign(static_cast<size_t>(width) * height, VisibilitySample());
+    directions.resize(samples.size());
+
+    const float farAway = std::numeric_limits<float>::max();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            directions[y * width + x] = rays.direction(x, y);
+            samples[y * width + x].nearestEntry = farAway;
+            samples[y * width + x].secondEntry = farAway;
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(objects.size()); ++i) {
+        AABB bounds = objects[i]->getBounds();
+        Rect rect = projectBounds(bounds, rays);
+
+        for (int y = rect.y0; y <= rect.y1; ++y) {
+            for (int x = rect.x0; x <= rect.x1; ++x) {
+                const glm::vec3& d = directions[y * width + x];
+                float entry = bounds.rayEntry(rays.origin, glm::vec3(1.0f / d.x, 1.0f / d.y, 1.0f / d.z));
+                if (entry < 0.0f) continue;
+
+                VisibilitySample& sample = samples[y * width + x];
+                if (entry < sample.nearestEntry) {
+                    sample.secondEntry = sample.nearestEntry;
+                    sample.nearestEntry = entry;
+                    sample.candidate = i;
+                } else if (entry < sample.secondEntry) {
+                    sample.secondEntry = entry;
+                }
+            }
+        }
+    }
+}
+
+VisibilityBuffer::Rect VisibilityBuffer::projectBounds(const AABB& bounds, const RayGenerator& rays) const {
+    const Rect fullScreen = {0, 0, width - 1, height - 1};
+    const float nearPlane = 1e-3f;
+
+    float minX = std::numeric_limits<float>::max(), minY = minX;
+    float maxX = -minX, maxY = -minX;
+    for (int corner = 0; corner < 8; ++corner) {
+        glm::vec3 p(corner & 1 ? bounds.max.x : bounds.min.x,
+                    corner & 2 ? bounds.max.y : bounds.min.y,
+                    corner & 4 ? bounds.max.z : bounds.min.z);
+        glm::vec3 d = p - rays.origin;
+        float depth = glm::dot(d, rays.forward);
+        // A box crossing the camera plane has no finite projection
+        if (depth < nearPlane) return fullScreen;
+
+        // Inverse of RayGenerator::direction
+        float screenX = glm::dot(d, rays.right) / depth / (rays.aspectRatio * rays.tanHalfFov);
+        float screenY = glm::dot(d, rays.up) / depth / rays.tanHalfFov;
+        float px = (screenX + 1.0f) * width / 2.0f - 0.5f;
+        float py = (1.0f - screenY) * height / 2.0f - 0.5f;
+        minX = std::min(minX, px);
+        maxX = std::max(maxX, px);
+        minY = std::min(minY, py);
+        maxY = std::max(maxY, py);
+    }
+
+    // One pixel of slack covers rounding; the slab test decides the rest
+    minX = std::max(minX, -2.0f);
+    minY = std::max(minY, -2.0f);
+    maxX = std::min(maxX, width + 1.0f);
+    maxY = std::min(maxY, height + 1.0f);
+    Rect rect;
+    rect.x0 = std::max(0, static_cast<int>(std::floor(minX)) - 1);
+    rect.y0 = std::max(0, static_cast<int>(std::floor(minY)) - 1);
+    rect.x1 = std::min(width - 1, static_cast<int>(std::ceil(maxX)) + 1);
+    rect.y1 = std::min(height - 1, static_cast<int>(std::ceil(maxY)) + 1);
+    return rect;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "camera.h"
+#include "object.h"
+
+// Per-pixel result of the visibility pass.
+struct VisibilitySample {
+    int candidate = -1;        // object whose bounds the primary ray enters first, -1 if none
+    float nearestEntry = 0.0f; // entry distance into the candidate's bounds
+    float secondEntry = 0.0f;  // nearest entry into any other object's bounds
+};
+
+// Rasterizes every object's bounding box into a per-pixel candidate/depth
+// buffer before tracing. Each box is projected to a conservative screen
+// rectangle and the exact slab entry distance is computed for the pixels
+// inside it, so:
+//   - a pixel with no candidate hits nothing and only needs the skybox;
+//   - a candidate hit closer than secondEntry is provably the nearest hit,
+//     because every other object's hit lies inside its own bounds.
+// Everything else (candidate missed, overlapping bounds) falls back to the
+// full traversal.
+class VisibilityBuffer {
+public:
+    void build(const std::vector<Object*>& objects, const RayGenerator& rays);
+
+    const VisibilitySample& at(int x, int y) const { return samples[y * width + x]; }
+    const glm::vec3& direction(int x, int y) const { return directions[y * width + x]; }
+
+private:
+    struct Rect {
+        int x0, y0, x1, y1;
+    };
+
+    Rect projectBounds(const AABB& bounds, const RayGenerator& rays) const;
+
+    int width = 0;
+    int height = 0;
+    std::vector<VisibilitySample> samples;
+    std::vector<glm::vec3> directions;
+};
@@ -0,0 +1,31 @@
+# Farm fault tolerance check, run by ctest from src/:
+#   cmake -DPROGRAM=<Proyecto3_GS> -DOUTPUT_DIR=<dir> -P farm_fault_tolerance.cmake
+# Renders the same frame on a single worker and on three workers where worker 0
+# is killed when it is handed its third tile and worker 1 sleeps before every
+# tile. The killed worker's tile has to be re-queued, and re-issued or
+# duplicated tiles must not change a single byte of the result.
+set(FRAME --width 140 --height 120 --tile-size 16)
+set(REFERENCE ${OUTPUT_DIR}/farm_reference.ppm)
+set(FAULTS ${OUTPUT_DIR}/farm_faults.ppm)
+
+execute_process(COMMAND ${PROGRAM} --farm 1 ${FRAME} --farm-output ${REFERENCE}
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "single worker render failed (${result})")
+endif()
+
+execute_process(COMMAND ${PROGRAM} --farm 3 --farm-kill-worker 3 --farm-slow-worker 200 ${FRAME} --farm-output ${FAULTS}
+                RESULT_VARIABLE result ERROR_VARIABLE log)
+message("${log}")
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "render with injected faults failed (${result})")
+endif()
+if(NOT log MATCHES "killed by --farm-kill-worker, re-queued [1-9]")
+    message(FATAL_ERROR "the killed worker's tiles were not re-queued")
+endif()
+
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${REFERENCE} ${FAULTS}
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "${FAULTS} differs from the single worker render ${REFERENCE}")
+endif()